@@ -0,0 +1,65 @@
+#!/bin/bash
+#
+# bench.sh -- times the crawler on a synthetic site served on the loopback interface
+#
+# Generates a site with sitegen, serves it with siteserve and crawls all of it
+# once for every number of connections given, with no politeness delay, printing
+# the pages crawled per second. Needs no network.
+#
+# usage: bench.sh [depth] [fanout] [pagesize] [connections ...]
+#   depth       : depth of the site and of the crawl (default 3)
+#   fanout      : links from each page to the next level (default 10)
+#   pagesize    : bytes of text on each page (default 4096)
+#   connections : 0 for one fetch at a time, else fetches in flight (default 0 1 4 16)
+#
+# PORT sets the port to serve on (default 8088).
+
+DEPTH=${1:-3}
+FANOUT=${2:-10}
+SIZE=${3:-4096}
+# whatever follows the first three arguments is the list of connections
+shift $(( $# < 3 ? $# : 3 ))
+CONNS=${@:-0 1 4 16}
+PORT=${PORT:-8088}
+PREFIX=http://127.0.0.1:${PORT}
+
+HERE=$(cd "$(dirname "$0")" && pwd)
+CRAWLER=${HERE}/../crawler/crawler
+
+if [ ! -x ${CRAWLER} ]; then
+		echo "build the crawler first (makeall.sh)"
+		exit 1
+fi
+
+make -s -C ${HERE} all >/dev/null || exit 1
+
+SITE=$(mktemp -d)
+PAGES=$(mktemp -d)
+
+# stop the server and remove the site however the script ends
+trap 'kill ${SERVER} 2>/dev/null; rm -rf ${SITE} ${PAGES}' EXIT
+
+${HERE}/sitegen ${SITE} ${DEPTH} ${FANOUT} ${SIZE} || exit 1
+${HERE}/siteserve ${SITE} -p ${PORT} >/dev/null &
+SERVER=$!
+
+# wait for the server to listen
+for i in $(seq 50); do
+		curl -s -o /dev/null ${PREFIX}/p0.html && break
+		sleep 0.1
+done
+
+printf "%12s %8s %9s %10s\n" connections pages seconds pages/sec
+for C in ${CONNS}; do
+		rm -rf ${PAGES}/*
+		FLAGS="-r 0 -w 0 -p ${PREFIX}"
+		[ ${C} != 0 ] && FLAGS="${FLAGS} -c ${C}"
+
+		START=$(date +%s.%N)
+		${CRAWLER} ${PREFIX}/p0.html ${PAGES} ${DEPTH} ${FLAGS} >/dev/null || exit 1
+		END=$(date +%s.%N)
+
+		N=$(wc -l < ${PAGES}/.changed)
+		awk -v c=${C} -v n=${N} -v s=${START} -v e=${END} \
+				'BEGIN { printf "%12s %8d %9.3f %10.1f\n", c, n, e - s, n/(e - s) }'
+done
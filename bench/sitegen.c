@@ -0,0 +1,199 @@
+/*
+ * sitegen.c --- generates a synthetic website to crawl
+ *
+ * Author: Joshua M. Meise
+ * Created: 11-12-2023
+ * Version: 1.0
+ *
+ * Description: Writes pages p0.html, p1.html, ... into a directory. The pages form a tree: page i links to
+ *              pages i*fanout + 1 to i*fanout + fanout, down to the given depth, so that a crawl from p0.html to
+ *              that depth reaches every page. Each page also links to a number of pages picked at random, which
+ *              the crawler has to recognise as already seen, and holds about the given number of bytes of text
+ *              drawn from a fixed vocabulary with a few very common words and many rare ones. The same arguments
+ *              always give the same site.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/stat.h>
+
+// Usage message printed on any bad argument.
+#define USAGE "usage: sitegen <sitedir> <depth> <fanout> <pagesize> [-x <crosslinks>] [-n <maxpages>] [-s <seed>]\n"
+
+// Number of distinct words in the text of the site.
+#define VOCABULARY 5000
+
+// State of the random number generator.
+static uint64_t state;
+
+/*
+ * Returns the next pseudo-random number (xorshift64*).
+ */
+static uint64_t nextRandom(void) {
+	state ^= state >> 12;
+	state ^= state << 25;
+	state ^= state >> 27;
+
+	return state*0x2545f4914f6cdd1dULL;
+}
+
+/*
+ * Returns a pseudo-random number in [0, 1).
+ */
+static double uniform(void) {
+	return (nextRandom() >> 11)*(1.0/9007199254740992.0);
+}
+
+/*
+ * Prints the usage message and exits.
+ */
+static void usage(void) {
+	printf(USAGE);
+	exit(EXIT_FAILURE);
+}
+
+/*
+ * Reads a non-negative integer argument, exiting on anything else.
+ */
+static long readCount(char *arg) {
+	// Variable declarations.
+	char *str;
+	long n;
+
+	n = strtol(arg, &str, 10);
+	if (n < 0 || *str != '\0' || str == arg)
+		usage();
+
+	return n;
+}
+
+/*
+ * Makes up a vocabulary of words of 3 to 10 lowercase letters.
+ * Outputs: the words, NULL on failure.
+ */
+static char **makeVocabulary(void) {
+	// Variable declarations.
+	char **words;
+	int32_t i, j, len;
+
+	if ((words = (char **)malloc(VOCABULARY*sizeof(char *))) == NULL)
+		return NULL;
+
+	for (i = 0; i < VOCABULARY; i++) {
+		len = 3 + nextRandom()%8;
+		if ((words[i] = (char *)malloc(len + 1)) == NULL)
+			return NULL;
+		for (j = 0; j < len; j++)
+			words[i][j] = 'a' + nextRandom()%26;
+		words[i][len] = '\0';
+	}
+
+	return words;
+}
+
+/*
+ * Writes one page.
+ * Inputs: directory; page number; number of pages; fanout; number of random links; bytes of text; vocabulary.
+ * Outputs: 0 for success; non-zero otherwise.
+ */
+static int32_t writePage(char *dir, long id, long pages, long fanout, long cross, long size, char **words) {
+	// Variable declarations.
+	char name[4096];
+	FILE *ofile;
+	long i, written, link;
+	char *word;
+
+	snprintf(name, sizeof(name), "%s/p%ld.html", dir, id);
+	if ((ofile = fopen(name, "w")) == NULL)
+		return 1;
+
+	fprintf(ofile, "<html>\n<head><title>Page %ld</title></head>\n<body>\n<p>\n", id);
+
+	// Common words come up far more often than rare ones.
+	for (written = 0; written < size; written += strlen(word) + 1) {
+		word = words[(long)(VOCABULARY*uniform()*uniform()*uniform())];
+		fprintf(ofile, "%s%c", word, written%80 < 70 ? ' ' : '\n');
+	}
+	fprintf(ofile, "\n</p>\n<ul>\n");
+
+	// Links down the tree, then anywhere.
+	for (i = 1; i <= fanout && id*fanout + i < pages; i++)
+		fprintf(ofile, "<li><a href=\"p%ld.html\">page %ld</a></li>\n", id*fanout + i, id*fanout + i);
+	for (i = 0; i < cross && pages > 1; i++) {
+		link = nextRandom()%pages;
+		fprintf(ofile, "<li><a href=\"p%ld.html\">page %ld</a></li>\n", link, link);
+	}
+
+	fprintf(ofile, "</ul>\n</body>\n</html>\n");
+
+	if (fclose(ofile) != 0)
+		return 1;
+
+	return 0;
+}
+
+int main(int argc, char *argv[]) {
+	// Variable declarations.
+	long depth, fanout, size, cross, maxPages, pages, level, d, i;
+	char **words;
+	struct stat st;
+
+	if (argc < 5 || argc%2 == 0)
+		usage();
+
+	depth = readCount(argv[2]);
+	fanout = readCount(argv[3]);
+	size = readCount(argv[4]);
+
+	// Two random links a page, no limit on the number of pages and a fixed seed unless told otherwise.
+	cross = 2;
+	maxPages = 0;
+	state = 1;
+
+	for (i = 5; i < argc; i += 2) {
+		if (strcmp(argv[i], "-x") == 0)
+			cross = readCount(argv[i + 1]);
+		else if (strcmp(argv[i], "-n") == 0)
+			maxPages = readCount(argv[i + 1]);
+		else if (strcmp(argv[i], "-s") == 0)
+			state = readCount(argv[i + 1]) + 1;
+		else
+			usage();
+	}
+
+	// Count the pages of a tree of the given depth and fanout.
+	for (pages = 1, level = 1, d = 1; d <= depth && fanout > 0; d++) {
+		level *= fanout;
+		pages += level;
+		if (maxPages > 0 && pages >= maxPages)
+			break;
+	}
+	if (maxPages > 0 && pages > maxPages)
+		pages = maxPages;
+
+	// The directory may already exist.
+	if (mkdir(argv[1], 0777) != 0 && (stat(argv[1], &st) != 0 || S_ISDIR(st.st_mode) == 0)) {
+		printf("cannot create %s\n", argv[1]);
+		exit(EXIT_FAILURE);
+	}
+
+	if ((words = makeVocabulary()) == NULL)
+		exit(EXIT_FAILURE);
+
+	for (i = 0; i < pages; i++)
+		if (writePage(argv[1], i, pages, fanout, cross, size, words) != 0) {
+			printf("cannot write page %ld\n", i);
+			exit(EXIT_FAILURE);
+		}
+
+	printf("%ld pages in %s; crawl from p0.html\n", pages, argv[1]);
+
+	for (i = 0; i < VOCABULARY; i++)
+		free(words[i]);
+	free(words);
+
+	exit(EXIT_SUCCESS);
+}
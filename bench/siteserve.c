@@ -0,0 +1,278 @@
+/*
+ * siteserve.c --- serves a directory of pages over HTTP on the loopback interface
+ *
+ * Author: Joshua M. Meise
+ * Created: 11-12-2023
+ * Version: 1.0
+ *
+ * Description: A stand-in for a web server, so that the crawler can be run and timed without a network.
+ *              Listens on 127.0.0.1 and answers GET and HEAD requests for files in the directory, one thread
+ *              per connection, keeping connections open between requests as HTTP/1.1 clients expect. Pages
+ *              carry a Last-Modified header, and a request whose If-Modified-Since matches it is answered
+ *              304 Not Modified, so recrawls can be timed too.
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+// Usage message printed on any bad argument.
+#define USAGE "usage: siteserve <sitedir> [-p <port>]\n"
+
+// Longest request header accepted.
+#define MAXREQUEST 8192
+
+// Directory being served.
+static char *siteDir;
+
+/*
+ * Prints the usage message and exits.
+ */
+static void usage(void) {
+	printf(USAGE);
+	exit(EXIT_FAILURE);
+}
+
+/*
+ * Writes all of a buffer to a socket.
+ * Outputs: 0 for success, non-zero otherwise.
+ */
+static int32_t sendAll(int fd, const char *buf, size_t len) {
+	// Variable declarations.
+	ssize_t n;
+
+	while (len > 0) {
+		if ((n = write(fd, buf, len)) <= 0)
+			return 1;
+		buf += n;
+		len -= n;
+	}
+
+	return 0;
+}
+
+/*
+ * Copies the value of a request header into value, which holds size characters.
+ * Inputs: request headers; header name; where to put the value and its size.
+ * Outputs: true if the request has the header.
+ */
+static bool getHeader(char *request, const char *name, char *value, size_t size) {
+	// Variable declarations.
+	char *line, *end;
+	size_t len = strlen(name), n;
+
+	for (line = strstr(request, "\r\n"); line != NULL; line = strstr(line, "\r\n")) {
+		line += 2;
+		if (strncasecmp(line, name, len) == 0 && line[len] == ':') {
+			line += len + 1;
+			while (*line == ' ')
+				line++;
+			if ((end = strstr(line, "\r\n")) == NULL)
+				end = line + strlen(line);
+			n = end - line < size - 1 ? end - line : size - 1;
+			memcpy(value, line, n);
+			value[n] = '\0';
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * Answers one request.
+ * Inputs: connection; request headers, terminated.
+ * Outputs: 0 to keep the connection open, non-zero to close it.
+ */
+static int32_t answer(int fd, char *request) {
+	// Variable declarations.
+	char method[16], target[2048], version[16], path[PATH_MAX], header[1024], lastmod[64], since[64], value[64];
+	char *body = NULL;
+	struct stat st;
+	struct tm tm;
+	int file, status;
+	bool keep, head;
+	ssize_t n;
+	size_t len = 0, got;
+
+	if (sscanf(request, "%15s %2047s %15s", method, target, version) != 3)
+		return 1;
+
+	// HTTP/1.1 keeps the connection open unless told otherwise.
+	keep = strcmp(version, "HTTP/1.1") == 0;
+	if (getHeader(request, "Connection", value, sizeof(value)) == true)
+		keep = strcasecmp(value, "close") != 0 && (keep || strcasecmp(value, "keep-alive") == 0);
+
+	head = strcmp(method, "HEAD") == 0;
+	target[strcspn(target, "?#")] = '\0';
+
+	// Only plain files inside the directory are served.
+	status = 404;
+	if (strcmp(method, "GET") != 0 && head == false)
+		status = 501;
+	else if (target[0] == '/' && strstr(target, "..") == NULL) {
+		snprintf(path, sizeof(path), "%s%s%s", siteDir, target, strcmp(target, "/") == 0 ? "index.html" : "");
+		if ((file = open(path, O_RDONLY)) != -1) {
+			if (fstat(file, &st) == 0 && S_ISREG(st.st_mode)) {
+				gmtime_r(&st.st_mtime, &tm);
+				strftime(lastmod, sizeof(lastmod), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+
+				if (getHeader(request, "If-Modified-Since", since, sizeof(since)) == true && strcmp(since, lastmod) == 0)
+					status = 304;
+				else {
+					status = 200;
+					len = st.st_size;
+					if (head == false && (body = (char *)malloc(len + 1)) != NULL) {
+						for (got = 0; got < len && (n = pread(file, body + got, len - got, got)) > 0; got += n)
+							;
+						if (got < len) {
+							free(body);
+							body = NULL;
+							status = 500;
+							len = 0;
+						}
+					}
+					else if (head == false)
+						status = 500;
+				}
+			}
+			close(file);
+		}
+	}
+
+	if (status == 200 || status == 304)
+		snprintf(header, sizeof(header), "HTTP/1.1 %d %s\r\nContent-Type: text/html\r\nContent-Length: %zu\r\n"
+						 "Last-Modified: %s\r\nConnection: %s\r\n\r\n", status, status == 200 ? "OK" : "Not Modified",
+						 len, lastmod, keep ? "keep-alive" : "close");
+	else
+		snprintf(header, sizeof(header), "HTTP/1.1 %d %s\r\nContent-Length: 0\r\nConnection: %s\r\n\r\n", status,
+						 status == 404 ? "Not Found" : status == 501 ? "Not Implemented" : "Internal Server Error",
+						 keep ? "keep-alive" : "close");
+
+	if (sendAll(fd, header, strlen(header)) != 0 || (body != NULL && sendAll(fd, body, len) != 0))
+		keep = false;
+
+	free(body);
+	return keep ? 0 : 1;
+}
+
+/*
+ * Answers the requests on one connection until the client closes it.
+ * Inputs: the connection's descriptor, in malloc'd memory.
+ * Outputs: NULL.
+ */
+static void *serve(void *arg) {
+	// Variable declarations.
+	int fd = *(int *)arg;
+	char buf[MAXREQUEST + 1], *end;
+	size_t have = 0, used;
+	ssize_t n;
+
+	free(arg);
+
+	for (;;) {
+		// Read until the end of a request's headers.
+		buf[have] = '\0';
+		while ((end = strstr(buf, "\r\n\r\n")) == NULL) {
+			if (have == MAXREQUEST || (n = read(fd, buf + have, MAXREQUEST - have)) <= 0) {
+				close(fd);
+				return NULL;
+			}
+			have += n;
+			buf[have] = '\0';
+		}
+
+		// Answer it, then keep whatever came after it for the next one.
+		end[2] = '\0';
+		used = end + 4 - buf;
+		if (answer(fd, buf) != 0)
+			break;
+		memmove(buf, buf + used, have - used);
+		have -= used;
+	}
+
+	close(fd);
+	return NULL;
+}
+
+int main(int argc, char *argv[]) {
+	// Variable declarations.
+	struct sockaddr_in addr;
+	struct stat st;
+	int listener, fd, *arg, on = 1;
+	long port;
+	char *str;
+	pthread_t tid;
+
+	if (argc != 2 && argc != 4)
+		usage();
+
+	// Serve on port 8080 unless told otherwise.
+	port = 8080;
+	if (argc == 4) {
+		port = strtol(argv[3], &str, 10);
+		if (strcmp(argv[2], "-p") != 0 || port <= 0 || port > 65535 || *str != '\0')
+			usage();
+	}
+
+	siteDir = argv[1];
+	if (stat(siteDir, &st) != 0 || S_ISDIR(st.st_mode) == 0)
+		usage();
+
+	// A client hanging up must not take the server down with it.
+	signal(SIGPIPE, SIG_IGN);
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = htons(port);
+
+	if ((listener = socket(AF_INET, SOCK_STREAM, 0)) == -1 ||
+			setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) != 0 ||
+			bind(listener, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(listener, 128) != 0) {
+		perror("siteserve");
+		exit(EXIT_FAILURE);
+	}
+
+	printf("serving %s at http://127.0.0.1:%ld\n", siteDir, port);
+	fflush(stdout);
+
+	// One thread per connection.
+	for (;;) {
+		if ((fd = accept(listener, NULL, NULL)) == -1)
+			continue;
+
+		// Headers and body go out in separate writes; do not hold the body back waiting for an ack.
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+		if ((arg = (int *)malloc(sizeof(int))) == NULL) {
+			close(fd);
+			continue;
+		}
+		*arg = fd;
+
+		if (pthread_create(&tid, NULL, serve, arg) != 0) {
+			free(arg);
+			close(fd);
+			continue;
+		}
+		pthread_detach(tid);
+	}
+}
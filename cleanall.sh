@@ -31,7 +31,7 @@ if [ $# == 1 ] && ([ $1 == "-s" ] || [ $1 == "-sq" ] || [ $1 == "-qs" ]); then
 fi
 
 # make all of the components
-for DIR in utils crawler indexer querier parallel_indexer
+for DIR in utils crawler indexer querier parallel_indexer bench
 do
 
 		if [ -d ./${DIR} ] ; then
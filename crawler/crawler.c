@@ -9,156 +9,989 @@
  * 
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 // Libraries to include.
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <webpage.h>
-#include <queue.h>
+#include <frontier.h>
+#include <urlset.h>
+#include <checkpoint.h>
 #include <hash.h>
+#include <simhash.h>
 #include <string.h>
+#include <limits.h>
 #include <unistd.h>
+#include <time.h>
 #include <sys/stat.h>
 #include <pageio.h>
+#include <lqueue.h>
+#include <index.h>
+#include <indexio.h>
+#include <pthread.h>
+
+// Most saved pages waiting for an indexing thread before the crawl waits for one.
+#define MAXJOBS (64)
+
+// Longest link normalised without allocating memory for it.
+#define MAXURL (2048)
+
+// Usage message printed on any bad argument.
+#define USAGE "usage: crawler <seedurl> <pagedir> <maxdepth> [-c <connections>] [-r <rate>] [-w <mindelay>] [-b <bloombits>] [-k <pages>] [-d <distance>] [-s] [-i <indexnm> [-t <threads>]] [-p <prefix>] [--resume] [--recrawl]\n"
+
+/* This structure contains the state of one crawl. */
+typedef struct crawl {
+	frontier_t *fr;
+	urlset_t *seen;
+	char *pagedir;
+	int32_t maxDepth;
+	int32_t docID;
+	int32_t conns;
+	webpage_multi_t *mp;
+	checkpoint_t *cp;
+	int32_t every;
+	int32_t finished;
+	hashtable_t *known;
+	FILE *changed;
+	int32_t stored;
+	int32_t unchanged;
+	simindex_t *near;
+	hashtable_t *contents;
+	FILE *dups;
+	int32_t checked;
+	int32_t dupes;
+	int32_t exact;
+	bool stream;
+	lqueue_t *jobs;
+} crawl_t;
+
+/* This structure contains a page saved by an earlier crawl into the same directory. */
+typedef struct known {
+	char *url;
+	int32_t id;
+} known_t;
+
+/* This structure contains the content hash of a page saved by this crawl. */
+typedef struct content {
+	uint64_t hash;
+	int32_t id;
+} content_t;
+
+/* This structure contains a saved page waiting to be indexed; a page streamed to disk is loaded back instead. */
+typedef struct job {
+	int32_t id;
+	webpage_t *page;
+} job_t;
+
+/* This structure contains the state of one indexing thread. */
+typedef struct worker {
+	pthread_t tid;
+	lqueue_t *jobs;
+	char *pagedir;
+	index_t *index;
+	int32_t failed;
+} worker_t;
 
 /*
- * This function compares a URL of a given page to one in the hash table.
- * Inputs: URL to search for; URL in hash table.
- * Outputs: true if found in hash table; false if not found in hash table.
+ * Prints the usage message and exits.
  */
-bool search(void *elementp, const void *searchkeyp) {
-	// Declare variables and coerce to strings.
-	char *string = (char *)elementp;
-	char *searchString = (char *)searchkeyp;
+static void usage(void) {
+	printf(USAGE);
+	exit(EXIT_FAILURE);
+}
 
-	// See if URL passed in is same as relevant URL in hash table.
-	if (strcmp(string, searchString) == 0)
-		return true;
-	else
-		return false;
-	
+/*
+ * Sleeps for the given number of seconds.
+ */
+static void pauseFor(double seconds) {
+	struct timespec ts;
+
+	ts.tv_sec = (time_t)seconds;
+	ts.tv_nsec = (long)((seconds - ts.tv_sec)*1e9);
+	nanosleep(&ts, NULL);
+}
+
+/*
+ * This function compares the URL of a known page to a URL being searched for.
+ * Inputs: known page; URL.
+ * Outputs: true if the page has that URL.
+ */
+static bool searchKnown(void *elementp, const void *searchkeyp) {
+	return strcmp(((known_t *)elementp)->url, (const char *)searchkeyp) == 0;
+}
+
+/*
+ * Frees a known page.
+ */
+static void freeKnown(void *elementp) {
+	known_t *k = (known_t *)elementp;
+
+	free(k->url);
+	free(k);
+}
+
+/*
+ * Looks up the docID an earlier crawl saved a URL under.
+ * Inputs: crawl state; URL.
+ * Outputs: the docID, 0 if the URL is new.
+ */
+static int32_t knownID(crawl_t *c, char *url) {
+	known_t *k;
+
+	if (c->known == NULL || (k = (known_t *)hsearch(c->known, searchKnown, url, strlen(url))) == NULL)
+		return 0;
+
+	return k->id;
+}
+
+/*
+ * Reads the URL of every page already saved in the page directory, so that a recrawl can update them in place.
+ * Inputs: crawl state.
+ * Outputs: the docID after the last saved page.
+ */
+static int32_t loadKnown(crawl_t *c) {
+	// Variable declarations.
+	char url[8192];
+	known_t *k;
+	int32_t id;
+
+	// Only the URL of each page is needed.
+	for (id = 1; pageexists(id, c->pagedir); id++) {
+		if (pageurl(id, c->pagedir, url, sizeof(url)) == 0) {
+			if ((k = (known_t *)malloc(sizeof(known_t))) == NULL || (k->url = (char *)malloc(strlen(url) + 1)) == NULL)
+				exit(EXIT_FAILURE);
+			strcpy(k->url, url);
+			k->id = id;
+
+			hput(c->known, k, k->url, strlen(k->url));
+		}
+	}
+
+	return id;
+}
+
+/*
+ * Gets a page ready to be fetched. The fetch of a page saved by an earlier crawl is made conditional on it
+ * having changed since; a new page at the maximum depth, whose links are never needed, may be streamed
+ * straight to disk, unless it has to be checked for duplicates.
+ * Inputs: crawl state; page about to be fetched.
+ */
+static void prepareFetch(crawl_t *c, webpage_t *page) {
+	// Variable declarations.
+	pagemeta_t meta;
+	int32_t id;
+
+	if ((id = knownID(c, webpage_getURL(page))) != 0) {
+		if (pagemetaload(&meta, id, c->pagedir) == 0)
+			webpage_setValidators(page, meta.etag, meta.lastmod);
+	}
+	else if (c->stream == true && c->near == NULL && webpage_getDepth(page) == c->maxDepth)
+		pagestreambegin(page, c->pagedir);
+}
+
+/*
+ * Fills in the metadata of a fetched page; the hash of a page streamed to disk is left unknown (0).
+ * Inputs: fetched page; where to put its metadata.
+ */
+static void describePage(webpage_t *page, pagemeta_t *meta) {
+	meta->etag[0] = '\0';
+	meta->lastmod[0] = '\0';
+	if (webpage_getETag(page) != NULL)
+		strncat(meta->etag, webpage_getETag(page), MAXVALIDATOR - 1);
+	if (webpage_getLastModified(page) != NULL)
+		strncat(meta->lastmod, webpage_getLastModified(page), MAXVALIDATOR - 1);
+	meta->hash = 0;
+	if (webpage_getSink(page) == NULL)
+		meta->hash = urlfingerprint(webpage_getHTML(page), webpage_getHTMLlen(page));
+}
+
+/*
+ * Extracts every link from a page and queues the internal ones that have not been seen before.
+ * Inputs: crawl state; page holding the links; depth of that page in this crawl.
+ * Outputs: 0 for success; non-zero otherwise.
+ */
+static int32_t queueLinks(crawl_t *c, webpage_t *page, int32_t depth) {
+	// Variable declarations.
+	int32_t i, n, len, size, added;
+	char url[MAXURL], *str;
+	uint64_t fp;
+	webpage_t *newPage;
+	webpage_link_t *links;
+	webpage_base_t base;
+	bool haveBase;
+
+	// Obtain all links from page in one pass.
+	if ((n = webpage_getLinks(page, &links)) < 0)
+		return 1;
+
+	// The page's URL is parsed once for all of its links.
+	haveBase = webpage_getBase(page, &base);
+
+	for (i = 0; i < n; i++) {
+		// Links are normalised in a buffer on the stack; only one too long for it gets a buffer of its own.
+		str = url;
+		if ((len = webpage_canonLink(page, haveBase ? &base : NULL, &links[i], str, MAXURL, &fp)) < 0) {
+			size = links[i].len + strlen(webpage_getURL(page)) + 2;
+			if ((str = (char *)malloc(size)) == NULL) {
+				free(links);
+				return 1;
+			}
+			len = webpage_canonLink(page, haveBase ? &base : NULL, &links[i], str, size, &fp);
+		}
+
+		// Only work with internal URLs that have not been seen before; adding marks them seen. A URL that
+		// cannot be marked would be lost, so the crawl stops instead.
+		added = 0;
+		if (len > 0 && webpage_isInternal(str) == true && (added = usaddfp(c->seen, fp)) < 0) {
+			printf("Visited-URL set cannot grow.\n");
+			if (str != url)
+				free(str);
+			free(links);
+			return 1;
+		}
+
+		if (added == 1) {
+			// Create a new webpage to put into the frontier.
+			newPage = webpage_new(str, depth + 1, NULL);
+
+			// Put new webpage into the frontier.
+			if (frput(c->fr, newPage) != 0 || cpqueued(c->cp, newPage) != 0) {
+				if (str != url)
+					free(str);
+				free(links);
+				return 1;
+			}
+		}
+
+		// The page keeps its own copy of the URL.
+		if (str != url)
+			free(str);
+	}
+
+	free(links);
+	return 0;
+}
+
+/*
+ * Hands a saved page to the indexing threads, waiting while they are behind.
+ * Inputs: crawl state; saved page, NULL to have it loaded from its file; its docID.
+ * Outputs: 0 for success; non-zero otherwise.
+ */
+static int32_t indexLater(crawl_t *c, webpage_t *page, int32_t id) {
+	// Variable declarations.
+	job_t *job;
+	char *html;
+
+	if (c->jobs == NULL)
+		return 0;
+
+	if ((job = (job_t *)malloc(sizeof(job_t))) == NULL)
+		return 1;
+	job->id = id;
+	job->page = NULL;
+
+	// The page is deleted once the crawl is done with it, so the threads get a copy.
+	if (page != NULL) {
+		if ((html = strdup(webpage_getHTML(page))) == NULL ||
+				(job->page = webpage_new(webpage_getURL(page), webpage_getDepth(page), html)) == NULL) {
+			free(html);
+			free(job);
+			return 1;
+		}
+	}
+
+	if (lqputwait(c->jobs, job) != 0) {
+		if (job->page != NULL)
+			webpage_delete(job->page);
+		free(job);
+		return 1;
+	}
+
+	return 0;
+}
+
+/*
+ * Indexes saved pages into a private index until the crawl is over.
+ * Inputs: the thread's worker_t.
+ * Outputs: NULL.
+ */
+static void *indexPages(void *arg) {
+	// Variable declarations.
+	worker_t *w = (worker_t *)arg;
+	job_t *job;
+	webpage_t *page;
+
+	while ((job = (job_t *)lqgetwait(w->jobs)) != NULL) {
+		if ((page = job->page) == NULL)
+			page = pageload(job->id, w->pagedir);
+
+		if (page == NULL || indexpage(w->index, page, job->id) != 0)
+			w->failed++;
+
+		if (page != NULL)
+			webpage_delete(page);
+		free(job);
+	}
+
+	return NULL;
+}
+
+/*
+ * Writes a fetched page and its metadata under a docID and lists the docID as changed.
+ * Inputs: crawl state; fetched page; docID.
+ * Outputs: 0 for success; -1 if the page could not be saved and is skipped; 1 for any other failure.
+ */
+static int32_t storePage(crawl_t *c, webpage_t *page, int32_t id) {
+	// Variable declarations.
+	pagemeta_t meta;
+
+	// Save the webpage, then what a later crawl needs to tell whether it changed; one page that cannot be
+	// saved does not end the crawl.
+	if (pagesave(page, id, c->pagedir) != 0) {
+		printf("Page %s not saved.\n", webpage_getURL(page));
+		return -1;
+	}
+
+	describePage(page, &meta);
+	if (pagemetasave(&meta, id, c->pagedir) != 0)
+		return 1;
+
+	// The indexer only needs to look at the pages listed here.
+	if (fprintf(c->changed, "%d\n", id) < 0 || fflush(c->changed) != 0)
+		return 1;
+
+	if (indexLater(c, page, id) != 0)
+		return 1;
+
+	c->stored++;
+	return 0;
+}
+
+/*
+ * Finishes a page whose html was streamed to disk by its fetch, keeping it under the next docID if the fetch
+ * succeeded.
+ * Inputs: crawl state; page handed back by its fetch; whether the fetch succeeded.
+ * Outputs: 0 for success; non-zero otherwise.
+ */
+static int32_t finishStream(crawl_t *c, webpage_t *page, bool ok) {
+	// Variable declarations.
+	pagemeta_t meta;
+
+	if (ok == false)
+		return pagestreamend(page, 0, c->pagedir);
+
+	describePage(page, &meta);
+	if (pagestreamend(page, c->docID, c->pagedir) != 0 || pagemetasave(&meta, c->docID, c->pagedir) != 0)
+		return 1;
+
+	if (fprintf(c->changed, "%d\n", c->docID) < 0 || fflush(c->changed) != 0)
+		return 1;
+
+	if (indexLater(c, NULL, c->docID) != 0)
+		return 1;
+
+	c->docID++;
+	c->stored++;
+	return 0;
+}
+
+/*
+ * Saves a fetched page under the next docID and queues its links unless it is at the maximum depth.
+ * Inputs: crawl state; fetched page.
+ * Outputs: 0 for success; -1 if the page was skipped, keeping its docID for the next page; 1 otherwise.
+ */
+static int32_t savePage(crawl_t *c, webpage_t *page) {
+	// Variable declarations.
+	int32_t res;
+
+	// Save the webpage.
+	if ((res = storePage(c, page, c->docID)) != 0)
+		return res;
+
+	// Increase the docID so that the file name changes accordingly
+	c->docID++;
+
+	// Links on the deepest pages are never followed.
+	if (webpage_getDepth(page) < c->maxDepth && queueLinks(c, page, webpage_getDepth(page)) != 0)
+		return 1;
+
+	return 0;
+}
+
+/*
+ * Brings a page saved by an earlier crawl up to date, rewriting it only if its content changed, and queues its links.
+ * Inputs: crawl state; fetched page; docID it was saved under.
+ * Outputs: 0 for success; non-zero otherwise.
+ */
+static int32_t refreshPage(crawl_t *c, webpage_t *page, int32_t id) {
+	// Variable declarations.
+	pagemeta_t old, meta;
+	webpage_t *saved = NULL;
+	int32_t depth = webpage_getDepth(page), result = 0;
+
+	// The server says the page has not changed: its links are those of the saved copy.
+	if (webpage_notModified(page) == true) {
+		c->unchanged++;
+		if (depth < c->maxDepth) {
+			if ((saved = pageload(id, c->pagedir)) == NULL)
+				return 1;
+			result = queueLinks(c, saved, depth);
+			webpage_delete(saved);
+		}
+		return result;
+	}
+
+	// Otherwise compare content, using the saved copy itself if its hash is unknown.
+	describePage(page, &meta);
+	if (pagemetaload(&old, id, c->pagedir) != 0 || old.hash == 0) {
+		if ((saved = pageload(id, c->pagedir)) == NULL)
+			return 1;
+		describePage(saved, &old);
+		webpage_delete(saved);
+	}
+
+	// A page that cannot be saved keeps its old copy.
+	if (meta.hash != old.hash) {
+		if (storePage(c, page, id) > 0)
+			return 1;
+	}
+	else {
+		c->unchanged++;
+
+		// Keep new validators so that the next recrawl can ask the server.
+		if ((strcmp(meta.etag, old.etag) != 0 || strcmp(meta.lastmod, old.lastmod) != 0) &&
+				pagemetasave(&meta, id, c->pagedir) != 0)
+			return 1;
+	}
+
+	if (depth < c->maxDepth && queueLinks(c, page, depth) != 0)
+		return 1;
+
+	return 0;
+}
+
+/*
+ * This function compares the content hash of a saved page to the one being searched for.
+ * Inputs: saved page's content; content hash.
+ * Outputs: true if the hashes match.
+ */
+static bool searchContent(void *elementp, const void *searchkeyp) {
+	return ((content_t *)elementp)->hash == *(const uint64_t *)searchkeyp;
+}
+
+/*
+ * Looks for a page saved by this crawl that a new page duplicates: first one with exactly the same
+ * content, then one whose SimHash is close enough.
+ * Inputs: crawl state; new page; where to put its content hash, its SimHash and its number of words.
+ * Outputs: docID of the page it duplicates, 0 if it is new.
+ */
+static int32_t duplicateOf(crawl_t *c, webpage_t *page, uint64_t *hash, uint64_t *sim, int32_t *words) {
+	// Variable declarations.
+	content_t *same;
+	int32_t id;
+
+	c->checked++;
+
+	// Identical content needs no tokenizing.
+	*hash = urlfingerprint(webpage_getHTML(page), webpage_getHTMLlen(page));
+	if ((same = (content_t *)hsearch(c->contents, searchContent, (const char *)hash, sizeof(*hash))) != NULL) {
+		c->dupes++;
+		c->exact++;
+		return same->id;
+	}
+
+	// A page without words has no SimHash worth comparing; only its exact content counts.
+	*sim = simhash(page, words);
+	if (*words == 0)
+		return 0;
+
+	if ((id = sifind(c->near, *sim)) != 0)
+		c->dupes++;
+
+	return id;
+}
+
+/*
+ * Remembers the fingerprints of a page saved by this crawl, so that later copies of it are found.
+ * Inputs: crawl state; content hash; SimHash; number of words it was made from; docID.
+ * Outputs: 0 for success; non-zero otherwise.
+ */
+static int32_t rememberPage(crawl_t *c, uint64_t hash, uint64_t sim, int32_t words, int32_t id) {
+	// Variable declarations.
+	content_t *k;
+
+	if ((k = (content_t *)malloc(sizeof(content_t))) == NULL)
+		return 1;
+	k->hash = hash;
+	k->id = id;
+
+	if (hput(c->contents, k, (const char *)&k->hash, sizeof(k->hash)) != 0 ||
+			(words > 0 && siadd(c->near, sim, id) != 0))
+		return 1;
+
+	return 0;
+}
+
+/*
+ * Remembers the fingerprints of every page saved before a crawl was interrupted, so that the resumed crawl
+ * still finds copies of them.
+ * Inputs: crawl state, whose docID follows the last page saved.
+ * Outputs: 0 for success; non-zero otherwise.
+ */
+static int32_t rememberSaved(crawl_t *c) {
+	// Variable declarations.
+	webpage_t *page;
+	uint64_t hash, sim;
+	int32_t id, words;
+
+	for (id = 1; id < c->docID; id++) {
+		// Pages that were not kept, if any, have nothing to remember.
+		if ((page = pageload(id, c->pagedir)) == NULL)
+			continue;
+
+		hash = urlfingerprint(webpage_getHTML(page), webpage_getHTMLlen(page));
+		sim = simhash(page, &words);
+		webpage_delete(page);
+
+		if (rememberPage(c, hash, sim, words, id) != 0)
+			return 1;
+	}
+
+	return 0;
+}
+
+/*
+ * Marks a new page as a duplicate of a saved one instead of saving it, and still queues its links.
+ * Inputs: crawl state; duplicate page; docID of the page it duplicates.
+ * Outputs: 0 for success; non-zero otherwise.
+ */
+static int32_t skipDuplicate(crawl_t *c, webpage_t *page, int32_t of) {
+	if (fprintf(c->dups, "%d %s\n", of, webpage_getURL(page)) < 0 || fflush(c->dups) != 0)
+		return 1;
+
+	if (webpage_getDepth(page) < c->maxDepth && queueLinks(c, page, webpage_getDepth(page)) != 0)
+		return 1;
+
+	return 0;
+}
+
+/*
+ * Saves a page if its fetch succeeded, logs that it is finished and takes a snapshot every so many pages.
+ * Inputs: crawl state; page handed back by a fetch; whether the fetch succeeded.
+ * Outputs: 0 for success; non-zero otherwise.
+ */
+static int32_t finishPage(crawl_t *c, webpage_t *page, bool ok) {
+	// Variable declarations.
+	int32_t id = 0, of, res, words;
+	uint64_t hash, sim;
+
+	// Pages streamed to disk only need their file finishing.
+	if (webpage_getSink(page) != NULL) {
+		if (ok == true)
+			id = c->docID;
+		if (finishStream(c, page, ok) != 0)
+			return 1;
+	}
+	// Save successfully fetched pages and queue their links.
+	else if (ok == true) {
+		if ((id = knownID(c, webpage_getURL(page))) != 0) {
+			if (refreshPage(c, page, id) != 0)
+				return 1;
+		}
+		// New pages that duplicate one already saved are not saved again.
+		else if (c->near != NULL && (of = duplicateOf(c, page, &hash, &sim, &words)) != 0) {
+			if (skipDuplicate(c, page, of) != 0)
+				return 1;
+		}
+		else {
+			id = c->docID;
+			if ((res = savePage(c, page)) < 0)
+				id = 0;
+			else if (res != 0 || (c->near != NULL && rememberPage(c, hash, sim, words, id) != 0))
+				return 1;
+		}
+	}
+
+	// Log the page as finished, saved or not.
+	if (cpdone(c->cp, page, id) != 0)
+		return 1;
+
+	// Every so often replace the log with a fresh snapshot.
+	c->finished++;
+	if (c->finished%c->every == 0 && cpsnapshot(c->cp, c->docID, c->seen, c->fr, c->mp) != 0)
+		return 1;
+
+	return 0;
+}
+
+/*
+ * Crawls one page at a time, blocking on each fetch.
+ * Inputs: crawl state.
+ * Outputs: 0 for success; non-zero otherwise.
+ */
+static int32_t crawlSerial(crawl_t *c) {
+	// Variable declarations.
+	webpage_t *page;
+	double wait;
+
+	// Keep fetching webpages until the frontier runs dry.
+	while (frempty(c->fr) == false) {
+		// Wait until some host may be fetched again.
+		if ((page = frget(c->fr, &wait)) == NULL) {
+			pauseFor(wait);
+			continue;
+		}
+
+		// Save the page if it can be fetched.
+		prepareFetch(c, page);
+		if (finishPage(c, page, webpage_fetch(page)) != 0)
+			return 1;
+
+		// Free memory from current page.
+		webpage_delete(page);
+	}
+
+	return 0;
+}
+
+/*
+ * Crawls with up to a given number of fetches in flight at once.
+ * Pages are saved in the order their fetches complete.
+ * Inputs: crawl state.
+ * Outputs: 0 for success; non-zero otherwise.
+ */
+static int32_t crawlConcurrent(crawl_t *c) {
+	// Variable declarations.
+	webpage_multi_t *mp;
+	webpage_t *page;
+	double wait;
+	bool ok;
+
+	// Open the driver for concurrent fetches; pages in flight belong in every snapshot.
+	if ((mp = webpage_multi_new(c->conns)) == NULL)
+		return 1;
+	c->mp = mp;
+
+	// Keep going until nothing is left to fetch.
+	for (;;) {
+		// Fill all free connections with pages from hosts that may be fetched now.
+		wait = -1;
+		while (webpage_multi_inflight(mp) < c->conns && (page = frget(c->fr, &wait)) != NULL) {
+			prepareFetch(c, page);
+			if (webpage_multi_add(mp, page) == true)
+				continue;
+
+			// A page that cannot be fetched is finished as a failed fetch, so that it is logged as done and not lost.
+			if (finishPage(c, page, false) != 0)
+				return 1;
+			webpage_delete(page);
+		}
+
+		// Nothing in flight and nothing queued means the crawl is over.
+		if (webpage_multi_inflight(mp) == 0) {
+			if (wait < 0)
+				break;
+
+			// Only politeness is holding the crawl back.
+			pauseFor(wait);
+			continue;
+		}
+
+		// Wait for a fetch to complete, or until another host becomes eligible.
+		if ((page = webpage_multi_next(mp, wait < 0 ? -1 : (int)(wait*1000) + 1, &ok)) == NULL)
+			continue;
+
+		// Save successfully fetched pages and queue their links.
+		if (finishPage(c, page, ok) != 0)
+			return 1;
+
+		// Free memory from current page.
+		webpage_delete(page);
+	}
+
+	c->mp = NULL;
+	webpage_multi_delete(mp);
+
+	return 0;
 }
 
 int main(int argc, char *argv[]) {
 	// Variable declarations.
-	int32_t maxDepth, docID, curDepth, pos;
-	char *str = NULL, *URL;
-	queue_t *q;
-	hashtable_t *h;
-	webpage_t *page, *newPage;
-	bool added;
+	int32_t maxDepth, conns, bloomBits, every, distance, i;
+	double rate, mindelay;
+	char *str = NULL;
+	crawl_t c;
+	webpage_t *page;
+	bool resume, recrawl, stream;
+	char name[PATH_MAX], *indexnm;
+	int32_t threads, failed;
+	worker_t *workers;
+	index_t *index;
 
 	// Check number of arguments.
-	if (argc != 4) {
-		printf("usage: crawler <seedurl> <pagedir> <maxdepth>\n");
-		exit(EXIT_FAILURE);
-	}
+	if (argc < 4)
+		usage();
 
 	// Extract the maximum depth.
 	maxDepth = strtol(argv[3], &str, 10);
 
 	// Check that maximum depth is positive and is an integer.
-	if (maxDepth < 0 || strcmp(str, "\0") != 0) {
- 		printf("usage: crawler <seedurl> <pagedir> <maxdepth>\n");
-		exit(EXIT_FAILURE);
+	if (maxDepth < 0 || strcmp(str, "\0") != 0)
+		usage();
+
+	// Zero connections means fetching one page at a time; by default each host is fetched at most once a second.
+	conns = 0;
+	rate = 1;
+	mindelay = 1;
+
+	// No Bloom filter in front of the visited set unless asked for.
+	bloomBits = 0;
+
+	// A snapshot of the crawl is taken every 100 pages; a crawl starts afresh unless told to resume.
+	every = 100;
+	resume = false;
+
+	// Duplicate pages are saved like any other unless a SimHash distance is given.
+	distance = -1;
+
+	// Every page is fetched into memory unless asked to stream the deepest ones.
+	stream = false;
+
+	// Pages already in the directory are overwritten unless recrawling them.
+	recrawl = false;
+
+	// Pages are indexed afterwards by the indexer unless an index file is given, by one thread unless told otherwise.
+	indexnm = NULL;
+	threads = 1;
+
+	// Read the optional flags; all but --resume take a value.
+	for (i = 4; i < argc; i += 2) {
+		if (strcmp(argv[i], "--resume") == 0) {
+			resume = true;
+			i--;
+			continue;
+		}
+
+		if (strcmp(argv[i], "--recrawl") == 0) {
+			recrawl = true;
+			i--;
+			continue;
+		}
+
+		if (strcmp(argv[i], "-s") == 0) {
+			stream = true;
+			i--;
+			continue;
+		}
+
+		if (i + 1 >= argc)
+			usage();
+
+		if (strcmp(argv[i], "-c") == 0) {
+			conns = strtol(argv[i + 1], &str, 10);
+			if (conns <= 0 || strcmp(str, "\0") != 0)
+				usage();
+		}
+		else if (strcmp(argv[i], "-r") == 0) {
+			rate = strtod(argv[i + 1], &str);
+			if (rate < 0 || strcmp(str, "\0") != 0)
+				usage();
+		}
+		else if (strcmp(argv[i], "-w") == 0) {
+			mindelay = strtod(argv[i + 1], &str);
+			if (mindelay < 0 || strcmp(str, "\0") != 0)
+				usage();
+		}
+		else if (strcmp(argv[i], "-b") == 0) {
+			bloomBits = strtol(argv[i + 1], &str, 10);
+			if (bloomBits < 0 || strcmp(str, "\0") != 0)
+				usage();
+		}
+		else if (strcmp(argv[i], "-k") == 0) {
+			every = strtol(argv[i + 1], &str, 10);
+			if (every <= 0 || strcmp(str, "\0") != 0)
+				usage();
+		}
+		else if (strcmp(argv[i], "-d") == 0) {
+			distance = strtol(argv[i + 1], &str, 10);
+			if (distance < 0 || distance > SIMHASH_MAXDISTANCE || strcmp(str, "\0") != 0)
+				usage();
+		}
+		else if (strcmp(argv[i], "-p") == 0)
+			webpage_setInternalPrefix(argv[i + 1]);
+		else if (strcmp(argv[i], "-i") == 0)
+			indexnm = argv[i + 1];
+		else if (strcmp(argv[i], "-t") == 0) {
+			threads = strtol(argv[i + 1], &str, 10);
+			if (threads <= 0 || strcmp(str, "\0") != 0)
+				usage();
+		}
+		else
+			usage();
 	}
 
-	// Initialise current depth to be 0 and insert webpage associated with seed at depth 0;
-	curDepth = 0;
-	page = webpage_new(argv[1], curDepth, NULL);
+	// An index built while crawling only covers the pages this run saves.
+	if (indexnm != NULL && (resume == true || recrawl == true)) {
+		printf("-i cannot be used with --resume or --recrawl; run the indexer afterwards\n");
+		usage();
+	}
 
-	// Open a queue to store webpages adn a has table to store pages already visited.
-	q = qopen();
-	h = hopen(1000);
+	// Initialise the crawl.
+	c.pagedir = argv[2];
+	c.maxDepth = maxDepth;
+	c.conns = conns;
+	c.mp = NULL;
+	c.every = every;
+	c.finished = 0;
+	c.known = NULL;
+	c.stored = 0;
+	c.unchanged = 0;
+	c.near = NULL;
+	c.contents = NULL;
+	c.dups = NULL;
+	c.checked = 0;
+	c.dupes = 0;
+	c.exact = 0;
+	c.stream = stream;
+	c.jobs = NULL;
+	workers = NULL;
 
-	// Put the first webpage into the queue.
-	if (qput(q, (void *)page) != 0)
+	// Open a frontier to store webpages.
+	if ((c.fr = fropen(rate, mindelay)) == NULL)
 		exit(EXIT_FAILURE);
 
-	// Allocate memory for the first webpage's URL and store it in a string.
-	URL = (char *)malloc(strlen(webpage_getURL(page))*sizeof(char) + 1);
-	strcpy(URL, webpage_getURL(page));
+	// Pick up an interrupted crawl where its checkpoint left off, if there is one.
+	if (resume == true && cpresume(c.pagedir, c.fr, &c.docID, &c.seen) != 0) {
+		printf("no checkpoint in %s; starting afresh\n", c.pagedir);
+		resume = false;
+	}
 
-	// Put the first URL into the hash table.
-	if (hput(h, (void *)URL, URL, sizeof(URL)) != 0)
+	if ((c.cp = cpopen(c.pagedir, resume)) == NULL)
 		exit(EXIT_FAILURE);
 
-	// Get the webpage out of the queue again.
-	page = (webpage_t *)qget(q);
-
-	// Set doc ID so that the first page to save saves in a fil with name "1".
-	docID = 1;
+	// List the docIDs this crawl writes, adding to the list of the crawl being resumed.
+	snprintf(name, sizeof(name), "%s/.changed", c.pagedir);
+	if ((c.changed = fopen(name, resume ? "a" : "w")) == NULL)
+		exit(EXIT_FAILURE);
 
-	// Keep writing webpages until reaching maximum depth.
-	while (curDepth <= maxDepth) {
-		// Fetch the html for a given webpage; if failure move on to next webpage.
-		while (webpage_fetch(page) == false) {
-			// Delete current qebpage that cannot be fetched.
-			webpage_delete(page);
+	// Duplicates are listed with the docID of the page they duplicate; a resumed crawl looks for copies of
+	// the pages saved before it was interrupted too.
+	if (distance >= 0) {
+		snprintf(name, sizeof(name), "%s/.duplicates", c.pagedir);
+		if ((c.near = siopen(distance)) == NULL || (c.contents = hopen(1000)) == NULL ||
+				(c.dups = fopen(name, resume ? "a" : "w")) == NULL)
+			exit(EXIT_FAILURE);
+		if (resume == true && rememberSaved(&c) != 0)
+			exit(EXIT_FAILURE);
+	}
 
-			// Get next webpage.
-			page = (webpage_t *)qget(q);
+	// A recrawl updates the pages already saved in place and numbers new ones after them.
+	if (recrawl == true) {
+		if ((c.known = hopen(1000)) == NULL)
+			exit(EXIT_FAILURE);
+		c.docID = loadKnown(&c);
+	}
 
-			// Update the current depth to new webpage's current depth.
-			curDepth = webpage_getDepth(page);
+	if (resume == false) {
+		// Set doc ID so that the first page to save is page "1", replacing whatever an earlier crawl saved.
+		if (recrawl == false) {
+			c.docID = 1;
+			if (pageclear(c.pagedir) != 0)
+				exit(EXIT_FAILURE);
 		}
 
-		// Save the webpage.
-		if (pagesave(page, docID, argv[2]) != 0)
+		// Open a set of the URLs already visited.
+		if ((c.seen = usopen(1000, bloomBits)) == NULL)
 			exit(EXIT_FAILURE);
 
-		// Increase the docID so that the file name changes accordingly
-		docID++;
+		// Insert webpage associated with seed at depth 0.
+		page = webpage_new(argv[1], 0, NULL);
+		if (frput(c.fr, page) != 0)
+			exit(EXIT_FAILURE);
 
-		// Get the next URL from the current page.
-		pos = webpage_getNextURL(page, 0, &str);
+		// Mark the first URL as visited.
+		if (usadd(c.seen, webpage_getURL(page)) < 0)
+			exit(EXIT_FAILURE);
 
-		// Obtain all links from page.				
-		while (pos != -1) {
-			added = false;
-			// Only work with internal URLs.
-			if (IsInternalURL(str) == true) {
-				// See if URL is already in hash table; if not then add to hash table and queue.
-				if (hsearch(h, search, str, sizeof(str)) == false) {
-					// Put URL into hash table.
-					if (hput(h, (void *) str, str, sizeof(str)) != 0)
-						exit(EXIT_FAILURE);
+		// Start the checkpoint from the seed alone.
+		if (cpsnapshot(c.cp, c.docID, c.seen, c.fr, NULL) != 0)
+			exit(EXIT_FAILURE);
+	}
 
-					// Create a new webpage to put into queue.
-					newPage = webpage_new(str, webpage_getDepth(page) + 1, NULL);
+	// Start the threads that index pages as they are saved, each into its own index.
+	if (indexnm != NULL) {
+		if ((c.jobs = lqopenbounded(MAXJOBS)) == NULL || (workers = (worker_t *)calloc(threads, sizeof(worker_t))) == NULL)
+			exit(EXIT_FAILURE);
 
-					// Put new webpage into queue.
-					if (qput(q, (void *)newPage) != 0)
-							exit(EXIT_FAILURE);
+		for (i = 0; i < threads; i++) {
+			workers[i].jobs = c.jobs;
+			workers[i].pagedir = c.pagedir;
+			if ((workers[i].index = indexopen(10000)) == NULL || pthread_create(&workers[i].tid, NULL, indexPages, &workers[i]) != 0)
+				exit(EXIT_FAILURE);
+		}
+	}
 
-					added = true;
-				}
-			}
+	// Crawl either one page at a time or with several fetches in flight.
+	if (conns == 0) {
+		if (crawlSerial(&c) != 0)
+			exit(EXIT_FAILURE);
+	}
+	else if (crawlConcurrent(&c) != 0)
+		exit(EXIT_FAILURE);
 
-			// Free string if not added to hash table.
-			if (added == false)
-				free(str);
+	// Record the finished crawl so that resuming it does nothing.
+	if (cpsnapshot(c.cp, c.docID, c.seen, c.fr, NULL) != 0)
+		exit(EXIT_FAILURE);
 
-			// Move onto next URL.
-			pos = webpage_getNextURL(page, pos, &str);
- 		}
+	// Let the threads finish the last pages, then combine their indexes into one and save it.
+	if (c.jobs != NULL) {
+		lqdone(c.jobs);
+		failed = 0;
+		for (i = 0; i < threads; i++) {
+			pthread_join(workers[i].tid, NULL);
+			failed += workers[i].failed;
+		}
 
-		// Free memory from current page.
- 		webpage_delete(page);
+		index = workers[0].index;
+		for (i = 1; i < threads; i++)
+			indexmerge(index, workers[i].index);
 
-		// Get next page from queue.
-		page = (webpage_t *)qget(q);
+		if (failed > 0)
+			printf("%d pages could not be indexed\n", failed);
+		if (indexsave(index, indexnm) != 0)
+			printf("Error saving index.\n");
 
-		// Update depth to be current page's depth.
-		curDepth = webpage_getDepth(page);
+		indexclose(index);
+		lqclose(c.jobs);
+		free(workers);
 	}
 
+	if (recrawl == true)
+		printf("recrawl: %d pages changed or new, %d unchanged\n", c.stored, c.unchanged);
+
+	if (c.near != NULL)
+		printf("dedupe: %d of %d new pages were duplicates (%.1f%%), %d of them exact\n", c.dupes, c.checked,
+					 c.checked > 0 ? 100.0*c.dupes/c.checked : 0.0, c.exact);
+
 	// Free all memory.
-	webpage_delete((void *)page);
- 	happly(h, free);
-	qapply(q, webpage_delete);
-	qclose(q);
-	hclose(h);
+	cpclose(c.cp);
+	if (c.near != NULL) {
+		siclose(c.near);
+		happly(c.contents, free);
+		hclose(c.contents);
+		fclose(c.dups);
+	}
+	fclose(c.changed);
+	if (c.known != NULL) {
+		happly(c.known, freeKnown);
+		hclose(c.known);
+	}
+	frapply(c.fr, webpage_delete);
+	frclose(c.fr);
+	usclose(c.seen);
+	webpage_setInternalPrefix(NULL);
 	
 	exit(EXIT_SUCCESS);
 
@@ -8,10 +8,17 @@
  * Description: Creates an index file for a given directory crawled by the crawler.
  *              Places words and their number of occurances into a hash table and writes to file.
  *              Given directory wihtin crawler, indexes all files in given directory.
+ *              With a memory budget, the index is spilled to a sorted file each time it outgrows the
+ *              budget and started again empty, and the spills are merged into the index file at the end.
+ *              A segmented index, a directory, is brought up to date by indexing only the changed pages into
+ *              a new segment; its segments are then merged in the background.
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdlib.h>
 #include <stdio.h>
+#include <limits.h>
 #include <webpage.h>
 #include <pageio.h>
 #include <string.h>
@@ -20,222 +27,264 @@
 #include <queue.h>
 #include <sys/stat.h>
 #include <indexio.h>
+#include <index.h>
+#include <segment.h>
 
-// Structure that contains a word and a queue that containts documents and number of occurances.
-typedef struct wordQ {
-	char *word;
-	queue_t *qp;
-} wordQ_t;
+// DocIDs listed as changed by the last crawl, used when updating an index.
+static int32_t *changedIDs = NULL;
+static int32_t numChanged = 0;
 
-// Structure that contains a document and a number of occurances.
-typedef struct docCount {
-	int doc;
-	int count;
-} docCount_t;
+// Bytes the index may take before it is spilled, 0 for no limit; names of the files spilled so far.
+static size_t budget = 0;
+static char **spillNames = NULL;
+static int32_t numSpills = 0;
 
 /*
- * This function compares the current word to one in the hash table.
- * Inputs: word to search for; word in hash table.
- * Outputs: true if found in hash table; false if not found in hash table.
+ * Adds the words of one page to the index.
+ * Inputs: index; page's docID; directory of the pages.
+ * Outputs: None.
  */
-static bool search(void *elementp, const void *searchkeyp) {
-	// Declare variables and coerce to valid datatypes.
-	wordQ_t *data = (wordQ_t *)elementp;
-	char *searchString = (char *)searchkeyp;
-	char *string = data->word;
-
-	// See if URL passed in is same as relevant URL in hash table.
-	if (strcmp(string, searchString) == 0)
-		return true;
-	else
-		return false;
-	
+static void indexPage(index_t *hash, int32_t curID, char *dirnm) {
+	// Variable declarations.
+	webpage_t *pageLoad;
+
+	// Load webpage at given index.
+	pageLoad = pageload(curID, dirnm);
+
+	if (indexpage(hash, pageLoad, curID) != 0)
+		printf("Problem indexing docID %d.\n", curID);
+
+	// Delete the webpage.
+	webpage_delete(pageLoad);
 }
 
 /*
- * This function compares a document ID of a given element to a document ID in the queue.
- * Inputs: docID to search for; docID in queue.
- * Outputs: true if found in queue; false if not found in queue.
+ * Spills the index to the next file named after the index file and starts a new, empty one.
+ * Inputs: pointer to the index; name of the index file.
+ * Outputs: 0 for success; non-zero otherwise.
  */
-static bool searchQueue(void *elementp, const void *searchkeyp) {
-	// Declare variables and coerce to valid datatypes.
-	docCount_t *data = (docCount_t *)elementp;
-	int *searchVal = (int *)searchkeyp;
-	int comp = data->doc;
-
-	// See if the 2 document IDs are the same.
-	if (comp == *searchVal)
-		return true;
-	else
-		return false;
-	
+static int32_t spill(index_t **hash, char *indexnm) {
+	// Variable declarations.
+	char *name;
+
+	if ((name = (char *)malloc(strlen(indexnm) + 20)) == NULL)
+		return 1;
+	sprintf(name, "%s.spill%d", indexnm, numSpills);
+
+	if ((spillNames = (char **)realloc(spillNames, sizeof(char *)*(numSpills + 1))) == NULL || indexspill(*hash, name) != 0) {
+		free(name);
+		return 1;
+	}
+	spillNames[numSpills++] = name;
+
+	indexclose(*hash);
+	return (*hash = indexopen(10000)) == NULL;
 }
 
 /*
- * Changes words to lowercase.
- * Discards words that are less than 3 characters or that contain non-alphanumeric characters.
- * Input: word to change
- * Output: 0 for a word that is successfully converted, 1 for a word that needs to be discarded.
+ * Merges the spilled files into the index file and removes them.
+ * Inputs: name of the index file.
+ * Outputs: 0 for success; non-zero otherwise.
  */
-static int normalizeWord(char *word) {
+static int32_t mergeSpills(char *indexnm) {
 	// Variable declarations.
-	int32_t i;
+	int32_t i, result;
 
-	// Word less than 3 characters get discarded.
-	if (strlen(word) < 3)
-		return 1;
-	
-	// Start at first character.
-	i = 0;
+	result = indexmergespills(spillNames, numSpills, indexnm, NULL);
 
-	// Loop through word and change all letters to lowercase.
-	while (i < strlen(word)) {
-		// Check if letter is alphanumeric. If not return 1.
-		if (isalpha(word[i]) == 0)
-			return 1;
-		
-		// Change word to lowercase.
-		if(word[i] >= 'A' && word [i] <= 'Z')
-			word[i] = tolower(word[i]);
-
-		// Increment i.
-		i++;
+	for (i = 0; i < numSpills; i++) {
+		remove(spillNames[i]);
+		free(spillNames[i]);
 	}
+	free(spillNames);
 
-	// Place null terminator at the end of the word.
-	word[i] = '\0';
-
-	return 0;
+	return result;
 }
 
 /*
- * Frees memory allocated for each word structure.
+ * Removes every posting of the changed documents from a word's queue.
  * Inputs: Pointer to a word structure.
  * Outputs: None.
  */
-static void freeW(void *data) {
-	// Coerce to vaild datatypes.
+static void dropChanged(void *data) {
+	// Variable declarations.
 	wordQ_t *wrd = (wordQ_t *)data;
+	int32_t i;
+
+	for (i = 0; i < numChanged; i++)
+		indexdrop(wrd, changedIDs[i]);
+}
 
-	// Free the memory that was allocated.
-	free(wrd->word);
-	qapply(wrd->qp, free);
-	qclose(wrd->qp);
-	free(wrd);
+/*
+ * Adds a docID to changedIDs.
+ * Inputs: docID; number of docIDs changedIDs has room for.
+ * Outputs: None.
+ */
+static void listChanged(int32_t id, int32_t *size) {
+	// Grow the list as needed.
+	if (numChanged == *size) {
+		*size = *size == 0 ? 64 : 2*(*size);
+		if ((changedIDs = (int32_t *)realloc(changedIDs, (*size)*sizeof(int32_t))) == NULL)
+			exit(EXIT_FAILURE);
+	}
+	changedIDs[numChanged++] = id;
+}
+
+/*
+ * Reads the docIDs the last crawl wrote from <pagedir>/.changed into changedIDs.
+ * Inputs: directory of the pages.
+ * Outputs: 0 for success; non-zero if there is no list.
+ */
+static int32_t readChanged(char *dirnm) {
+	// Variable declarations.
+	char name[PATH_MAX];
+	FILE *ifile;
+	int32_t id, size = 0;
+
+	snprintf(name, sizeof(name), "%s/.changed", dirnm);
+	if ((ifile = fopen(name, "r")) == NULL)
+		return 1;
+
+	while (fscanf(ifile, "%d", &id) == 1)
+		listChanged(id, &size);
+
+	fclose(ifile);
+	return 0;
+}
+
+/*
+ * Indexes the pages the last crawl changed, or every page if there is no list of them, into a new
+ * segment of a segmented index, then starts merging its segments in the background.
+ * Inputs: directory of the pages; index directory.
+ * Outputs: 0 for success; non-zero otherwise.
+ */
+static int32_t addSegment(char *dirnm, char *indexnm) {
+	// Variable declarations.
+	index_t *hash;
+	int32_t i, size = 0, result = 0;
+
+	if (readChanged(dirnm) != 0) {
+		for (i = 1; pageexists(i, dirnm); i++)
+			listChanged(i, &size);
+	}
+
+	// The segment only holds the pages listed; nothing listed leaves the index as it is.
+	if (numChanged != 0) {
+		if ((hash = indexopen(10000)) == NULL)
+			return 1;
+
+		for (i = 0; i < numChanged; i++)
+			indexPage(hash, changedIDs[i], dirnm);
+
+		result = sgadd(indexnm, hash, changedIDs, numChanged);
+		indexclose(hash);
+	}
+	free(changedIDs);
+
+	// The new pages are searched as soon as the segment is added; merging goes on after the indexer exits.
+	return result != 0 || sgmerge(indexnm, true) != 0;
 }
 
 int main(int argc, char *argv[]) {
 	// Variable declarations.
-	webpage_t *pageLoad;
-	char *readWord, fname[50];
-	int32_t pos, docID = 3, curID;
-	wordQ_t *wordQueue;
-	hashtable_t *hash;
-	docCount_t *dc;
+	int32_t curID, i;
+	index_t *hash = NULL;
 	struct stat dir;
+	bool update, segmented;
+	char *str = NULL;
+	long megabytes;
 	
 	// Check number of arguments.
-	if (argc != 3) {
-		printf("usage: indexer <pagedir> <indexnm>\n");
+	if ((argc != 3 && argc != 4 && argc != 5) || (argc == 4 && strcmp(argv[3], "-u") != 0 && strcmp(argv[3], "-s") != 0) || (argc == 5 && strcmp(argv[3], "-m") != 0)) {
+		printf("usage: indexer <pagedir> <indexnm> [-u | -s | -m <megabytes>]\n");
 		exit(EXIT_FAILURE);
 	}
 
+	// Only update an existing index with the pages the last crawl changed if asked to.
+	update = (argc == 4 && strcmp(argv[3], "-u") == 0);
+	segmented = (argc == 4 && strcmp(argv[3], "-s") == 0);
+
+	// Read the memory budget, if there is one.
+	if (argc == 5) {
+		megabytes = strtol(argv[4], &str, 10);
+		if (megabytes <= 0 || strcmp(str, "\0") != 0) {
+			printf("usage: indexer <pagedir> <indexnm> [-u | -s | -m <megabytes>]\n");
+			exit(EXIT_FAILURE);
+		}
+		budget = (size_t)megabytes << 20;
+	}
+
 	// Get details of directory.
 	if (stat(argv[1], &dir) != 0)
 		printf("Failure on stat.\n");
 
 	// Check if directory exists.
 	if (S_ISDIR(dir.st_mode) == 0) {
-		printf("usage: indexer <pagedir> <indexnm>\n");
+		printf("usage: indexer <pagedir> <indexnm> [-u | -s | -m <megabytes>]\n");
 		exit(EXIT_FAILURE);
 	}
 
-	// Open a hash table for the index.
-	if ((hash = hopen(10000)) == NULL)
-		printf("Failure on opening hash table.\n");
+	// A segmented index gets a segment of its own for the changed pages.
+	if (segmented == true) {
+		if (addSegment(argv[1], argv[2]) != 0) {
+			printf("Error adding segment.\n");
+			exit(EXIT_FAILURE);
+		}
+		exit(EXIT_SUCCESS);
+	}
+
+	// Without a list of changed pages every page has to be indexed.
+	if (update == true && readChanged(argv[1]) != 0) {
+		printf("No list of changed pages in %s; indexing every page.\n", argv[1]);
+		update = false;
+	}
 
-	// Initialise current ID.
-	curID = 1;
+	if (update == true) {
+		// Start from the existing index, if there is one, minus the changed pages.
+		if ((hash = indexload(argv[2])) != NULL)
+			fhapply(hash->words, dropChanged);
+		else if ((hash = indexopen(10000)) == NULL)
+			printf("Failure on opening index.\n");
 
-	// Initialise file name to be the first id.
-	sprintf(fname, "%s/%d", argv[1], curID);
-	
-	while (access(fname, R_OK) == 0) {
-		// Load webpage at given index.
-		pageLoad = pageload(curID, argv[1]);
-
-		// Initialise pos to be 0.
-		pos = 0;
-		
-		while ((pos = webpage_getNextWord(pageLoad, pos, &readWord)) > 0) {
-			// Only put word in hash table if it can be normalized.
-			if (normalizeWord(readWord) == 0) {
-				// If first occurance of word.
-				if ((wordQueue = hsearch(hash, search, readWord, strlen(readWord))) == NULL) {
-					// Create a new word structure.
-					if ((wordQueue = (wordQ_t *)malloc(sizeof(wordQ_t))) == NULL)
-						printf("Word-queue pair creation unseccessful.\n");
-					
-					// Allocate space for word.
-					if ((wordQueue->word = (char *)malloc(strlen(readWord)*sizeof(char) + 1)) == NULL)
-						printf("Word creation unseccessfu.\n");
-					
-					// Initialise word.
-					strcpy(wordQueue->word, readWord);
-					
-					// Open a queue associated with the word.
-					if ((wordQueue->qp = qopen()) == NULL)
-						printf("Queue not successfully opened.\n");
-					
-					// Put word int hash table.
-					if (hput(hash, wordQueue, wordQueue->word, strlen(wordQueue->word)) != 0)
-						printf("Unsuccessful put into hash word: %s.\n", wordQueue->word);
-
-				}
-	 
-				// Find the element in the word's queue associated with the current ID.
-				// If the document ID is not already in the queue.
-				if ((dc = (docCount_t *)qsearch(wordQueue->qp, searchQueue, (void *)&curID)) == NULL) {
-					// Create a new document/count pair.
-					if ((dc = (docCount_t *)malloc(sizeof(docCount_t))) == NULL)
-						printf("Doc count pair not successfully allocated.\n");
-					
-					// Initialise this new document/count pair.
-					dc->doc = curID;
-					dc->count = 1;
-					
-					// Put document/count pair into queue.
-					if (qput(wordQueue->qp, (void *)dc) != 0)
-						printf("Problem putting docID %d for word %s into queue.\n", docID, wordQueue->word);
-				}
-				// If the document ID is already in the queue.
-				else
-					// Increase the number of occurances in the specified document.
-					(dc->count)++;
+		// Index the changed pages again.
+		for (i = 0; i < numChanged; i++)
+			indexPage(hash, changedIDs[i], argv[1]);
+
+		free(changedIDs);
+	}
+	else {
+		// Open an index.
+		if ((hash = indexopen(10000)) == NULL)
+			printf("Failure on opening index.\n");
+
+		// Initialise current ID.
+		curID = 1;
+
+		while (pageexists(curID, argv[1])) {
+			// Index the page.
+			indexPage(hash, curID, argv[1]);
+
+			// Spill the index once it outgrows the budget.
+			if (budget != 0 && indexbytes(hash) > budget && spill(&hash, argv[2]) != 0) {
+				printf("Error spilling index.\n");
+				exit(EXIT_FAILURE);
 			}
-			// Free the word that was read from the webpage.
-			free(readWord);
+
+			// Increment current ID.
+			curID++;
 		}
-		// Delete the webpage.
-		webpage_delete(pageLoad);
-
-		// Increment current ID.
-		curID++;
-		
-		// File name should be the current page id.
-		sprintf(fname, "%s/%d", argv[1], curID);
-		
 	}
 	
-	
-	// Save index.
-	if (indexsave(hash, argv[2]) != 0)
+	// Save index; if any of it was spilled, the rest is spilled too and all of it merged.
+	if (numSpills == 0) {
+		if (indexsave(hash, argv[2]) != 0)
+			printf("Error saving index.\n");
+	}
+	else if ((fhcount(hash->words) != 0 && spill(&hash, argv[2]) != 0) || mergeSpills(argv[2]) != 0)
 		printf("Error saving index.\n");
 	
 	// Free memory.
-	happly(hash, freeW);
-	hclose(hash);
+	indexclose(hash);
 	
 	exit(EXIT_SUCCESS);
 }
-
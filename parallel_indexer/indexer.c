@@ -1,13 +1,19 @@
-/* 
+/*
  * indexer.c --- implements a multi-threaded indexer
- * 
+ *
  * Author: Joshua M. Meise
  * Created: 10-18-2023
  * Version: 1.0
- * 
+ *
  * Description: This program takes in as arguments a directory with webpages created by the crawler, the name of an index file and a number of threads.
- *              It opens the given number of threads, builds an index and then wrotes that index to an output file.
- * 
+ *              The pages are found, with their sizes, once, and split into runs of about the same number of bytes, several per thread.
+ *              Each thread takes runs with an atomic increment, with no lock, and builds an index of its own over their pages.
+ *              The threads then merge those indexes, each moving the words of its own part of the hash range into an index of its own,
+ *              and the parts, which share no words, are put together and written to the output file.
+ *              With a memory budget, split evenly between the threads, a thread whose index outgrows its share
+ *              spills it to a sorted file and starts again empty; if any thread spills, every index left at the
+ *              end is spilled too, and the spills are merged into the output file instead.
+ *
  */
 
 // Library inclusions.
@@ -16,360 +22,329 @@
 #include <webpage.h>
 #include <pageio.h>
 #include <string.h>
-#include <ctype.h>
-#include <lhash.h>
-#include <lqueue.h>
+#include <index.h>
+#include <indexio.h>
 #include <sys/stat.h>
 #include <pthread.h>
+#include <stdatomic.h>
+
+// Runs of pages for each thread; more than one, so that a thread given slow pages does not hold the others up at the end.
+#define RUNSPERTHREAD (8)
 
 // Global variables.
-lhashtable_t *hash;
-int32_t nextID;
 char directory[500];
-pthread_mutex_t m;
-FILE *ifile;
+char *indexName;
 
-// Structure that contains a word and a queue that containts documents and number of occurances.
-typedef struct wordQ {
-	char *word;
-	lqueue_t *qp;
-} wordQ_t;
+// Runs of pages: run i is the pages from runStart[i] up to runStart[i+1]; the next run to be taken.
+int32_t *runStart;
+int32_t numRuns;
+atomic_int nextRun;
 
-// Structure that contains a document and a number of occurances.
-typedef struct docCount {
-	int doc;
-	int count;
-} docCount_t;
+// Indexes each thread builds over its pages, then the parts of the words each thread merges them into.
+index_t **shards;
+index_t **parts;
+int32_t numThreads;
 
-/*
- * This function compares the current word to one in the hash table.
- * Inputs: word to search for; word in hash table.
- * Outputs: true if found in hash table; false if not found in hash table.
- */
-static bool search(void *elementp, const void *searchkeyp) {
-	// Declare variables and coerce to valid datatypes.
-	wordQ_t *data = (wordQ_t *)elementp;
-	char *searchString = (char *)searchkeyp;
-	char *string = data->word;
-
-	// See if URL passed in is same as relevant URL in hash table.
-	if (strcmp(string, searchString) == 0)
-		return true;
-	else
-		return false;
-	
-}
-
-/*
- * This function compares a document ID of a given element to a document ID in the queue.
- * Inputs: docID to search for; docID in queue.
- * Outputs: true if found in queue; false if not found in queue.
- */
-static bool searchQueue(void *elementp, const void *searchkeyp) {
-	// Declare variables and coerce to valid datatypes.
-	docCount_t *data = (docCount_t *)elementp;
-	int *searchVal = (int *)searchkeyp;
-	int comp = data->doc;
-
-	// See if the 2 document IDs are the same.
-	if (comp == *searchVal)
-		return true;
-	else
-		return false;
-	
-}
+// Bytes each thread's index may take before it is spilled, 0 for no limit; number of the next file to spill to.
+size_t budget;
+atomic_int nextSpill;
 
 /*
- * Changes words to lowercase.
- * Discards words that are less than 3 characters or that contain non-alphanumeric characters.
- * Input: word to change
- * Output: 0 for a word that is successfully converted, 1 for a word that needs to be discarded.
+ * Splits the pages, numbered from 1, into runs of about the same number of bytes.
+ * Inputs: Sizes of the pages; number of pages; number of runs wanted.
+ * Outputs: 0 for success; non-zero otherwise.
  */
-static int normalizeWord(char *word) {
+static int32_t splitRuns(size_t *sizes, int32_t numPages, int32_t runs) {
 	// Variable declarations.
+	size_t total = 0, target, bytes = 0;
 	int32_t i;
 
-	// Word less than 3 characters get discarded.
-	if (strlen(word) < 3)
+	for (i = 0; i < numPages; i++)
+		total += sizes[i];
+	target = total/runs + 1;
+
+	if ((runStart = (int32_t *)malloc(sizeof(int32_t)*(runs + 1))) == NULL)
 		return 1;
-	
-	// Start at first character.
-	i = 0;
-
-	// Loop through word and change all letters to lowercase.
-	while (i < strlen(word)) {
-		// Check if letter is alphanumeric. If not return 1.
-		if (isalpha(word[i]) == 0)
-			return 1;
-		
-		// Change word to lowercase.
-		if(word[i] >= 'A' && word [i] <= 'Z')
-			word[i] = tolower(word[i]);
-
-		// Increment i.
-		i++;
-	}
 
-	// Place null terminator at the end of the word.
-	word[i] = '\0';
+	// A run ends once it has its share of the bytes; the last one takes whatever is left.
+	numRuns = 0;
+	runStart[0] = 1;
+	for (i = 0; i < numPages && numRuns < runs - 1; i++) {
+		bytes += sizes[i];
+		if (bytes >= target*(numRuns + 1))
+			runStart[++numRuns] = i + 2;
+	}
+	if (runStart[numRuns] <= numPages)
+		numRuns++;
+	runStart[numRuns] = numPages + 1;
 
 	return 0;
-	
 }
 
 /*
- * Frees memory allocated for each word structure.
- * Inputs: Pointer to a word structure.
- * Outputs: None.
+ * Names the file a spill is written to, after the output file.
+ * Inputs: Number of the spill.
+ * Outputs: The name, to be freed by the caller; NULL if memory runs out.
  */
-static void freeW(void *data) {
-	// Coerce to vaild datatypes.
-	wordQ_t *wrd = (wordQ_t *)data;
-
-	// Free the memory that was allocated.
-	free(wrd->word);
-	lqapply(wrd->qp, free);
-	lqclose(wrd->qp);
-	free(wrd);
+static char *spillName(int32_t num) {
+	// Variable declarations.
+	char *name;
+
+	if ((name = (char *)malloc(strlen(indexName) + 20)) != NULL)
+		sprintf(name, "%s.spill%d", indexName, num);
+
+	return name;
 }
 
-/* Increments the file id number so that the next file is read.
- * No inputs or outputs.
+/*
+ * Spills an index to the next file and starts a new, empty one in its place.
+ * Inputs: Pointer to the index.
+ * Outputs: 0 for success; non-zero otherwise.
  */
-void updateNextID(void) {
-	// Lock mutex.
-	pthread_mutex_lock(&m);
+static int32_t spill(index_t **shard) {
+	// Variable declarations.
+	char *name;
+	int32_t result;
 
-	// Increment file ID number.
-	nextID++;
+	if ((name = spillName(atomic_fetch_add(&nextSpill, 1))) == NULL)
+		return 1;
+
+	result = indexspill(*shard, name);
+	free(name);
+	indexclose(*shard);
 
-	// Unlock mutex.
-	pthread_mutex_unlock(&m);
-	
+	return result != 0 || (*shard = indexopen(10000)) == NULL;
 }
 
 /*
  * Operates on each thread.
- * Reads saved pages into index.
- * Inputs: None.
+ * Reads the pages of the runs it takes into the thread's own index.
+ * Inputs: Pointer to the thread's index.
  * Outputs: NULL to terminate thread.
  */
 void *threadFunc(void *argp) {
 	// Variable declarations.
-	char fname[1000], *readWord;
-	int32_t pos, curID;
+	index_t **shard = (index_t **)argp;
+	int32_t run, curID;
 	webpage_t *pageLoad;
-	wordQ_t *wordQueue;
-	docCount_t *dc;
-
-	// Loop through all files in crawler directory.
-	do {
-
-		// Keep track of the current file being dealt with.
-		curID = nextID;
-
-		// Move onto the next file for the next thread.
-		updateNextID();
-		
-		// Initialise file name to be the current file being worked on.
-		sprintf(fname, "%s/%d", directory, curID);
-
-		// If file is not accessible, terminate thread.
-		if (access(fname, R_OK) != 0)
-			return NULL;
-		
-		// Load webpage for given id number.
-		pageLoad = pageload(curID, directory);
-
-		// Initialise pos to be 0.
-		pos = 0;
-
-		// Read through all words in a given webpage.
-		while ((pos = webpage_getNextWord(pageLoad, pos, &readWord)) > 0) {
-			// Only put word in hash table if it can be normalized.
-			if (normalizeWord(readWord) == 0) {
-				// If first occurance of word.
-				if ((wordQueue = lhsearch(hash, search, readWord, strlen(readWord))) == NULL) {
-					// Create a new word structure.
-					if ((wordQueue = (wordQ_t *)malloc(sizeof(wordQ_t))) == NULL)
-						printf("Word-queue pair creation unseccessful.\n");
-					
-					// Allocate space for word.
-					if ((wordQueue->word = (char *)malloc(strlen(readWord)*sizeof(char) + 1)) == NULL)
-						printf("Word creation unseccessful.\n");
-					
-					// Initialise word.
-					strcpy(wordQueue->word, readWord);
-					
-					// Open a queue associated with the word.
-					if ((wordQueue->qp = lqopen()) == NULL)
-						printf("Queue not successfully opened.\n");
-					
-					// Put word int hash table.
-					if (lhput(hash, wordQueue, wordQueue->word, strlen(wordQueue->word)) != 0)
-						printf("Unsuccessful put into hash word: %s.\n", wordQueue->word);
-				
-				}
-				// Find the element in the word's queue associated with the current ID.
-				// If the document ID is not already in the queue.
-				if ((dc = (docCount_t *)lqsearch(wordQueue->qp, searchQueue, (void *)&curID)) == NULL) {
-					// Create a new document/count pair.
-					if ((dc = (docCount_t *)malloc(sizeof(docCount_t))) == NULL)
-						printf("Doc count paur not successfully allocated.\n");
-					
-					// Initialise this new document/count pair.
-					dc->doc = curID;
-					dc->count = 1;
-					
-					// Put document/count pair into queue.
-					if (lqput(wordQueue->qp, (void *)dc) != 0)
-						printf("Problem putting docID %d for word %s into queue.\n", nextID, wordQueue->word);
-				}
-				// If the document ID is already in the queue.
-				else
-					// Increase the number of occurances in the specified document.
-					(dc->count)++;
+
+	// Take runs until there are none left.
+	while ((run = atomic_fetch_add(&nextRun, 1)) < numRuns) {
+		for (curID = runStart[run]; curID < runStart[run + 1]; curID++) {
+			// Load webpage for given id number.
+			pageLoad = pageload(curID, directory);
+
+			if (pageLoad == NULL || indexpage(*shard, pageLoad, curID) != 0)
+				printf("Problem indexing docID %d.\n", curID);
+
+			// Delete the webpage.
+			webpage_delete(pageLoad);
+
+			// Spill the index once it outgrows the thread's share of the budget.
+			if (budget != 0 && indexbytes(*shard) > budget && spill(shard) != 0) {
+				printf("Error spilling index.\n");
+				exit(EXIT_FAILURE);
 			}
-			// Free the word that was read from the webpage.
-			free(readWord);
 		}
-		// Delete the webpage.
-		webpage_delete(pageLoad);
-	} while (access(fname, R_OK) == 0);
+	}
 
 	return NULL;
 }
 
-/* 
- * Prints the document id and number of occurances into outout file.
- * Inputs: Pointer to the element in the queue that is to be printed into the file.
- * Outputs: None.
+/*
+ * Operates on each thread once all pages are indexed.
+ * Moves the words of one part of the hash range from every thread's index into the part's index.
+ * Inputs: Pointer to the part's number.
+ * Outputs: NULL to terminate thread.
  */
-static void printFileQ(void *data) {
-	// Variable declarations and coercion.
-	docCount_t *d = (docCount_t *)data;
+void *mergeFunc(void *argp) {
+	// Variable declarations.
+	int32_t part = *(int32_t *)argp, i;
+
+	for (i = 0; i < numThreads; i++)
+		indexmergepart(parts[part], shards[i], part, numThreads);
 
-	// Write the document id and the count to a file.
-	fprintf(ifile, " %d %d", d->doc, d->count);
+	return NULL;
 }
 
 /*
- * Prints word to file and calls function to print corresponding document ids and counts to file.
- * Inputs: Pointer to the word to be printed.
- * Outputs: None.
+ * Operates on each thread once all pages are indexed, if any index has been spilled.
+ * Spills what is left of the thread's index.
+ * Inputs: Pointer to the thread's index.
+ * Outputs: NULL to terminate thread.
  */
-static void printFileH(void *data) {
-	// Variable declaration and coercion.
-	wordQ_t *wrd = (wordQ_t *)data;
+void *spillFunc(void *argp) {
+	// Variable declarations.
+	index_t **shard = (index_t **)argp;
 
-	// Print word to file.
-	fprintf(ifile, "%s", wrd->word);
+	if (fhcount((*shard)->words) != 0 && spill(shard) != 0) {
+		printf("Error spilling index.\n");
+		exit(EXIT_FAILURE);
+	}
 
-	// Work through associated queue of document/count pairs and write them to file.
-	lqapply(wrd->qp, printFileQ);
-	
-	fprintf(ifile, "\n");
+	return NULL;
 }
 
 /*
- * Function to save an index to a file.
- * Inputs: Index to save, name of file to save to.
- * Outputs: 0 for success; non-zero for failure.
+ * Merges the spilled files into the output file and removes them.
+ * Outputs: 0 for success; non-zero otherwise.
  */
-int32_t indexsave(char *indexnm) {
-	// Check that hash and indexnm exist.
-	if (hash == NULL || indexnm == NULL)
-		return 1;
-	
-	// Open the file for writing.
-	ifile = fopen(indexnm, "w");
+static int32_t mergeSpills(void) {
+	// Variable declarations.
+	int32_t i, numSpills = atomic_load(&nextSpill), result = 0;
+	char **names;
 
-	// Return 1 if file not opened for writing properly.
-	if (access(indexnm, W_OK) != 0)
+	if ((names = (char **)calloc(numSpills + 1, sizeof(char *))) == NULL)
 		return 1;
 
-	// Write to the file using happly();
-	lhapply(hash, printFileH);
+	for (i = 0; i < numSpills && result == 0; i++)
+		if ((names[i] = spillName(i)) == NULL)
+			result = 1;
 
-	// Close reading file after loop has completed execution.
-	if (fclose(ifile) != 0)
-		printf("Error closing file.\n");
-	
-	return 0;
+	if (result == 0)
+		result = indexmergespills(names, numSpills, indexName, NULL);
+
+	for (i = 0; i < numSpills; i++) {
+		if (names[i] != NULL)
+			remove(names[i]);
+		free(names[i]);
+	}
+	free(names);
+
+	return result;
 }
 
 int main(int argc, char *argv[]) {
 	// Variable declarations.
 	char *str = NULL;
-	int32_t num, i;
+	int32_t i, *partNums, numPages;
+	size_t *sizes;
 	struct stat dir;
 	pthread_t *threads;
-	
+	index_t *index;
+	long megabytes;
+
 	// Check number of arguments.
-	if (argc != 4) {
-		printf("usage: indexer <pagedir> <indexnm> <numthreads>\n");
+	if ((argc != 4 && argc != 6) || (argc == 6 && strcmp(argv[4], "-m") != 0)) {
+		printf("usage: indexer <pagedir> <indexnm> <numthreads> [-m <megabytes>]\n");
 		exit(EXIT_FAILURE);
 	}
-	
+
 	// Get details of directory.
 	if (stat(argv[1], &dir) != 0)
 		printf("Failure on stat.\n");
 
 	// Check if directory exists; if not return 1.
 	if (S_ISDIR(dir.st_mode) == 0) {
-		printf("usage: indexer <pagedir> <indexnm> <numthreads>\n");
+		printf("usage: indexer <pagedir> <indexnm> <numthreads> [-m <megabytes>]\n");
 		exit(EXIT_FAILURE);
 	}
 
-	// Set the directory.
+	// Set the directory and the output file.
 	strcpy(directory, argv[1]);
-	
+	indexName = argv[2];
+
 	// Read the number of threads.
-	num = strtol(argv[3], &str, 10);
-	
+	numThreads = strtol(argv[3], &str, 10);
+
 	// Check that a valid number was enetered by the user.
-	if (num <= 0 || strcmp(str, "\0") != 0) {
-		printf("usage: indexer <pagedir> <indexnm> <numthreads>\n");
+	if (numThreads <= 0 || strcmp(str, "\0") != 0) {
+		printf("usage: indexer <pagedir> <indexnm> <numthreads> [-m <megabytes>]\n");
 		exit(EXIT_FAILURE);
 	}
-	
-	// Start off reading the first file.
-	nextID = 1;
-	
-	// Allocate memory for the given number of threads.
-	threads = (pthread_t *)malloc(sizeof(pthread_t)*num);
-
-	// Create the specified number of threads.
-	for (i = 0; i < num; i++) {
-		if(pthread_create(threads + i, NULL, threadFunc, NULL) != 0)
+
+	// Read the memory budget, if there is one, and split it between the threads.
+	budget = 0;
+	if (argc == 6) {
+		megabytes = strtol(argv[5], &str, 10);
+		if (megabytes <= 0 || strcmp(str, "\0") != 0) {
+			printf("usage: indexer <pagedir> <indexnm> <numthreads> [-m <megabytes>]\n");
 			exit(EXIT_FAILURE);
+		}
+		budget = ((size_t)megabytes << 20)/numThreads;
 	}
+	atomic_init(&nextSpill, 0);
 
-	// Open a hash table for the index.
-	if ((hash = lhopen(10000)) == NULL)
-		printf("Failure on opening hash table.\n");
+	// Find every page once, and split them between the threads by size.
+	if ((numPages = pagesizes(directory, &sizes)) < 0 || splitRuns(sizes, numPages, numThreads*RUNSPERTHREAD) != 0)
+		exit(EXIT_FAILURE);
+	free(sizes);
+	atomic_init(&nextRun, 0);
+
+	// Allocate memory for the given number of threads, their indexes and the parts they merge.
+	threads = (pthread_t *)malloc(sizeof(pthread_t)*numThreads);
+	shards = (index_t **)malloc(sizeof(index_t *)*numThreads);
+	parts = (index_t **)malloc(sizeof(index_t *)*numThreads);
+	partNums = (int32_t *)malloc(sizeof(int32_t)*numThreads);
+	if (threads == NULL || shards == NULL || parts == NULL || partNums == NULL)
+		exit(EXIT_FAILURE);
 
-	// Initialise mutex.
-	pthread_mutex_init(&m, NULL);
+	// Create the specified number of threads, each with an index of its own.
+	for (i = 0; i < numThreads; i++) {
+		if ((shards[i] = indexopen(10000)) == NULL || pthread_create(threads + i, NULL, threadFunc, shards + i) != 0)
+			exit(EXIT_FAILURE);
+	}
 
 	// Join all threads
-	for (i = 0; i < num; i++) {
+	for (i = 0; i < numThreads; i++) {
 		if (pthread_join(*(threads + i), NULL) != 0)
 			exit(EXIT_FAILURE);
 	}
 
+	// Once any index has been spilled, every thread spills what is left of its own, and the spills are merged.
+	if (atomic_load(&nextSpill) != 0) {
+		for (i = 0; i < numThreads; i++) {
+			if (pthread_create(threads + i, NULL, spillFunc, shards + i) != 0)
+				exit(EXIT_FAILURE);
+		}
+
+		for (i = 0; i < numThreads; i++) {
+			if (pthread_join(*(threads + i), NULL) != 0)
+				exit(EXIT_FAILURE);
+			indexclose(shards[i]);
+		}
+
+		if (mergeSpills() != 0)
+			printf("Error saving index.\n");
+
+		free(threads);
+		free(shards);
+		free(parts);
+		free(partNums);
+		free(runStart);
+		exit(EXIT_SUCCESS);
+	}
+
+	// Merge the threads' indexes, one part of the words per thread.
+	for (i = 0; i < numThreads; i++) {
+		partNums[i] = i;
+		if ((parts[i] = indexopen(10000)) == NULL || pthread_create(threads + i, NULL, mergeFunc, partNums + i) != 0)
+			exit(EXIT_FAILURE);
+	}
+
+	for (i = 0; i < numThreads; i++) {
+		if (pthread_join(*(threads + i), NULL) != 0)
+			exit(EXIT_FAILURE);
+	}
+
+	// The parts share no words, so putting them together only moves entries; the entries stay in the threads' indexes' memory.
+	index = parts[0];
+	for (i = 1; i < numThreads; i++)
+		indexmerge(index, parts[i]);
+	for (i = 0; i < numThreads; i++)
+		indexjoin(index, shards[i]);
+
 	// Save index.
-	if (indexsave(argv[2]) != 0)
+	if (indexsave(index, argv[2]) != 0)
 		printf("Error saving index.\n");
-	
+
 	// Free memory.
-	lhapply(hash, freeW);
-	lhclose(hash);
+	indexclose(index);
 	free(threads);
-	
-	// Destroy mutex.
-	pthread_mutex_destroy(&m);
+	free(shards);
+	free(parts);
+	free(partNums);
+	free(runStart);
 
 	exit(EXIT_SUCCESS);
 }
-
@@ -5,7 +5,7 @@
  * Created: 10-24-2023
  * Version: 1.0
  * 
- * Description: Given a file index and a directory of crawled pages, takes query input from the user and outputs ranked pages.
+ * Description: Given an index, a file or a directory of segments, and a directory of crawled pages, takes query input from the user and outputs ranked pages.
  * 
  */
 
@@ -16,71 +16,28 @@
 #include <ctype.h>
 #include <stdbool.h>
 #include <indexio.h>
+#include <index.h>
+#include <segment.h>
 #include <hash.h>
 #include <queue.h>
 #include <webpage.h>
+#include <analyze.h>
+#include <pageio.h>
 #include <unistd.h>
 
+// Longest URL of a document that is shown, the same as the crawler reads back from its pages.
+#define MAXURL (8192)
+
 // Global variables.
 int32_t max;
 
-// Structure that contains a word and a queue that containts documents and number of occurances.
-typedef struct wordQ {
-	char *word;
-	queue_t *qp;
-} wordQ_t;
-
-// Structure that contains a document and a number of occurances.
-typedef struct docCount {
-	int doc;
-	int count;
-} docCount_t;
-
 // Structure that contains a document's rank, id and associated URL.
 typedef struct doc {
 	int rank;
 	int docID;
-	char URL[500];
+	char URL[MAXURL];
 } doc_t;
 
-/*
- * This function compares the current word to one in the hash table.
- * Inputs: word to search for; word in hash table.
- * Outputs: true if found in hash table; false if not found in hash table.
- */
-static bool search(void *elementp, const void *searchkeyp) {
-	// Declare variables and coerce to valid datatypes.
-	wordQ_t *data = (wordQ_t *)elementp;
-	char *searchString = (char *)searchkeyp;
-	char *string = data->word;
-
-	// See if URL passed in is same as relevant URL in hash table.
-	if (strcmp(string, searchString) == 0)
-		return true;
-	else
-		return false;
-	
-}
-
-/*
- * This function compares a document ID of a given element to a document ID in the queue.
- * Inputs: docID to search for; docID in queue.
- * Outputs: true if found in queue; false if not found in queue.
- */
-static bool searchQueue(void *elementp, const void *searchkeyp) {
-	// Declare variables and coerce to valid datatypes.
-	docCount_t *data = (docCount_t *)elementp;
-	int *searchVal = (int *)searchkeyp;
-	int comp = data->doc;
-
-	// See if the 2 document IDs are the same.
-	if (comp == *searchVal)
-		return true;
-	else
-		return false;
-	
-}
-
 /*
  * This function compares the rank of a given document to the rank for whcih we are searching.
  * Inputs: document in queue; rank to sarch for.
@@ -108,13 +65,14 @@ static bool searchQueueRank(void *elementp, const void *searchkeyp) {
  */
 static int normalizeWord(char *word) {
 	// Variable declarations.
-	int32_t i;
+	int32_t i, len;
 		
-	// Start at first character.
+	// Start at first character; the length is measured once rather than on every pass.
 	i = 0;
+	len = strlen(word);
 
 	// Loop through word and change all letters to lowercase.
-	while (i < strlen(word)) {
+	while (i < len) {
 		// Check if letter is alphanumeric. If not return 1.
 		if (isalpha(word[i]) == 0)
 			return 1;
@@ -133,22 +91,6 @@ static int normalizeWord(char *word) {
 	return 0;
 }
 
-/*
- * Frees memory allocated for each word structure.
- * Inputs: Pointer to a word structure.
- * Outputs: None.
- */
-static void freeW(void *data) {
-	// Coerce to vaild datatypes.
-	wordQ_t *wrd = (wordQ_t *)data;
-
-	// Free the memory that was allocated.
-	free(wrd->word);
-	qapply(wrd->qp, free);
-	qclose(wrd->qp);
-	free(wrd);
-}
-
 /*
  * This function prints out the data in a queue of documents.
  * Inputs: the document to print.
@@ -198,14 +140,30 @@ static void getMaxRank(void *data) {
 
 }
 
+/*
+ * Puts the words of a query through the analysis the index was built with, so that they are searched for as they were indexed.
+ * Words less than 3 characters and stopwords are emptied, as they are not in the index; and/or are kept as they are.
+ * Inputs: words in the query; number of words in query; where to put the analyzed words.
+ * Outputs: None.
+ */
+static void analyzeQuery(char str[][80], int32_t i, char term[][80]) {
+	// Variable declarations.
+	int32_t j;
+
+	for (j = 0; j < i; j++) {
+		strcpy(term[j], str[j]);
+		if (strcmp(term[j], "and") != 0 && strcmp(term[j], "or") != 0 && (strlen(term[j]) < 3 || anword(term[j]) != 0))
+			term[j][0] = '\0';
+	}
+}
+
 /*
  * Rank the words in a query siring/subset of a query string.
  * Inputs: index; query string; end of subset; start of subset; the current file id.
  * Outputs: Rank of a particular word.
  */
-int rank(hashtable_t *index, char str[][80], int32_t i, int32_t j, int32_t curID) {
+int rank(segindex_t *index, char str[][80], int32_t i, int32_t j, int32_t curID) {
 	// Variable declarations.
-	wordQ_t *wordQueue;
 	docCount_t *dc;
 	int32_t cnt, min;
 	bool rank;
@@ -218,16 +176,11 @@ int rank(hashtable_t *index, char str[][80], int32_t i, int32_t j, int32_t curID
 	
 	// Word through the query string word by word.
 	while (j <= i) {
-		// Word less than 3 characters or and/or do nto get a rank.
-		if (strlen(str[j]) >= 3 && strcmp(str[j], "and") != 0 && strcmp(str[j], "or") != 0) {
-			// Search the index for the given word.
-			if ((wordQueue = hsearch(index, search, str[j], strlen(str[j]))) != NULL) {
-				// Get number of occurances of word in current document.
-				if ((dc = qsearch(wordQueue->qp, searchQueue, (void *)&curID)) != NULL)
-					cnt = dc->count;
-				else
-					cnt = 0;
-			}
+		// Words left out of the analysis (see analyze) and and/or do not get a rank.
+		if (str[j][0] != '\0' && strcmp(str[j], "and") != 0 && strcmp(str[j], "or") != 0) {
+			// Get number of occurances of word in current document from the segment of the index holding it.
+			if ((dc = sgdoc(index, str[j], curID)) != NULL)
+				cnt = dc->count;
 			else
 				cnt = 0;
 			
@@ -253,13 +206,12 @@ int rank(hashtable_t *index, char str[][80], int32_t i, int32_t j, int32_t curID
 
 int main(int argc, char *argv[]) {
 	// Variable declarations.
-	char str[20][80], inp[20*80], *beg = NULL, fname[60];
+	char str[20][80], term[20][80], inp[20*80], *beg = NULL;
 	int32_t i, j, min, curID, prevOrP1;
 	bool discard, quiet;
-	hashtable_t *index;
+	segindex_t *index;
 	queue_t *queueOfDocs;
 	doc_t *dp;
-	FILE *ifile;
 
 	// Check number of arguments.
 	if (argc != 3 && argc != 4) {
@@ -285,8 +237,8 @@ int main(int argc, char *argv[]) {
 	else
 		quiet = false;
 	
-	// Load in the index.
-	if ((index = indexload(argv[2])) == NULL)
+	// Load in the index: an index file, or every segment of a segmented index.
+	if ((index = sgload(argv[2])) == NULL)
 		printf("Index not successfully loaded.\n");
 
 	// Print out the first command prompt.
@@ -349,17 +301,17 @@ int main(int argc, char *argv[]) {
 				printf("\n");
 			}
 
+			// Analyze the words of the query once for all documents.
+			analyzeQuery(str, i, term);
+
 			// Open the queue of documents for the specific word.
 			queueOfDocs = qopen();
 
 			// Start off at the first file.
 			curID = 1;
 			
-			// Initialise file name to be the first id.
-			sprintf(fname, "%s/%d", argv[1], curID);
-
-			// Go through all the files in the crawler's pages directory.
-			while (access(fname, R_OK) == 0) {
+			// Go through all the pages in the crawler's pages directory.
+			while (pageexists(curID, argv[1])) {
 				// For each file reset the counter/indexer variables.
 				j = 0;
 				prevOrP1 = 0;
@@ -370,7 +322,7 @@ int main(int argc, char *argv[]) {
 					// Once an or is reached, rank the words in the substring.
 					if (strcmp(str[j], "or") == 0 || j == i - 1) {
 						// Use the rank function to rank the words in the substring and then add the rank to the overall rank for the query.
-						min += rank(index, str, j, prevOrP1, curID);
+						min += rank(index, term, j, prevOrP1, curID);
 
 						// Update the positon of the previous "or".
 						prevOrP1 = j + 1;
@@ -385,13 +337,8 @@ int main(int argc, char *argv[]) {
 				dp->docID = curID;
 
 				// Read the URL from the crawled webpage and place it into the document.
-				if ((ifile = fopen(fname, "r")) != NULL) {
-					if (fscanf(ifile, "%s", dp->URL) == 0)
-						printf("Reading URL not successful.\n");
-					
-					if (fclose(ifile) == EOF)
-						printf("File not closed successfully.\n");
-				}		
+				if (pageurl(curID, argv[1], dp->URL, sizeof(dp->URL)) != 0)
+					printf("Reading URL not successful.\n");
 				
 				// Rank the document.
 				dp->rank = min;
@@ -407,11 +354,6 @@ int main(int argc, char *argv[]) {
 
 				// Move onto next document.
 				curID++;
-				
-				// Initialise file name to be the first id.
-				sprintf(fname, "%s/%d", argv[1], curID);
-		
-				
 			}
 
 			max = 0;
@@ -440,8 +382,7 @@ int main(int argc, char *argv[]) {
 		printf("\n");
 
 	// Free memory.
-	happly(index, freeW);
-	hclose(index);
+	sgclose(index);
 	
 	exit(EXIT_SUCCESS);
 }
@@ -0,0 +1,346 @@
+/*
+ * analyze.c --- implements the analyze.h interface
+ *
+ * Author: Joshua M. Meise
+ * Created: 11-14-2023
+ * Version: 1.0
+ *
+ * Description: Stopwords are looked up in a perfect hash table generated from stopwords.txt by
+ *              stopgen: every stopword has a slot of its own, found from the webpage_termHash of the
+ *              word, so a word is checked with one multiply and one load, and compared letter by
+ *              letter only if its hash is a stopword's. The stemmer is M.F. Porter's algorithm ("An
+ *              algorithm for suffix stripping", Program 14(3), 1980), as in his reference version:
+ *              five steps each strip or replace a suffix if what is left of the word is long enough,
+ *              measured in vowel-consonant sequences.
+ *
+ */
+
+#include <analyze.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stopwords.h>
+
+// A word being stemmed: its letters b[0..k], and the end j of the stem before a suffix that ends matched.
+typedef struct stem {
+	char *b;
+	int32_t k;
+	int32_t j;
+} stem_t;
+
+/*
+ * Checks whether b[i] is a consonant: a letter other than a, e, i, o, u, and other than a y
+ * that follows a consonant.
+ */
+static bool consonant(stem_t *s, int32_t i) {
+	switch (s->b[i]) {
+	case 'a': case 'e': case 'i': case 'o': case 'u':
+		return false;
+	case 'y':
+		return i == 0 ? true : !consonant(s, i - 1);
+	default:
+		return true;
+	}
+}
+
+/*
+ * Measures the stem b[0..j]: the number of times a run of vowels is followed by a run of consonants.
+ */
+static int32_t measure(stem_t *s) {
+	// Variable declarations.
+	int32_t n = 0, i = 0;
+
+	// Skip the consonants the stem starts with.
+	while (i <= s->j && consonant(s, i))
+		i++;
+
+	for (;;) {
+		// A run of vowels, then one of consonants.
+		while (i <= s->j && !consonant(s, i))
+			i++;
+		if (i > s->j)
+			return n;
+		while (i <= s->j && consonant(s, i))
+			i++;
+		n++;
+	}
+}
+
+/*
+ * Checks whether the stem b[0..j] has a vowel.
+ */
+static bool vowelInStem(stem_t *s) {
+	// Variable declarations.
+	int32_t i;
+
+	for (i = 0; i <= s->j; i++)
+		if (!consonant(s, i))
+			return true;
+
+	return false;
+}
+
+/*
+ * Checks whether b[i-1..i] is a double consonant.
+ */
+static bool doubleConsonant(stem_t *s, int32_t i) {
+	return i >= 1 && s->b[i] == s->b[i - 1] && consonant(s, i);
+}
+
+/*
+ * Checks whether b[i-2..i] is consonant, vowel, consonant, the last not w, x or y, as in "hop".
+ */
+static bool cvc(stem_t *s, int32_t i) {
+	if (i < 2 || !consonant(s, i) || consonant(s, i - 1) || !consonant(s, i - 2))
+		return false;
+
+	return s->b[i] != 'w' && s->b[i] != 'x' && s->b[i] != 'y';
+}
+
+/*
+ * Checks whether the word ends with a suffix; if so, sets j to the end of the stem before it.
+ */
+static bool ends(stem_t *s, const char *suffix) {
+	// Variable declarations.
+	int32_t len = strlen(suffix);
+
+	if (len > s->k + 1 || memcmp(s->b + s->k - len + 1, suffix, len) != 0)
+		return false;
+
+	s->j = s->k - len;
+	return true;
+}
+
+/*
+ * Replaces whatever follows the stem b[0..j] with a suffix; no step makes the word longer than it was.
+ */
+static void setTo(stem_t *s, const char *suffix) {
+	// Variable declarations.
+	int32_t len = strlen(suffix);
+
+	memcpy(s->b + s->j + 1, suffix, len);
+	s->k = s->j + len;
+}
+
+/*
+ * Replaces the suffix ends matched if the stem has at least one vowel-consonant sequence.
+ */
+static void replace(stem_t *s, const char *suffix) {
+	if (measure(s) > 0)
+		setTo(s, suffix);
+}
+
+/*
+ * Step 1: plurals and -ed or -ing, as in caresses, ponies, cats, agreed, plastered, motoring,
+ * hopping, filing; then a final y after a vowel becomes i, as in happy.
+ */
+static void step1(stem_t *s) {
+	if (s->b[s->k] == 's') {
+		if (ends(s, "sses"))
+			s->k -= 2;
+		else if (ends(s, "ies"))
+			setTo(s, "i");
+		else if (s->b[s->k - 1] != 's')
+			s->k--;
+	}
+
+	if (ends(s, "eed")) {
+		if (measure(s) > 0)
+			s->k--;
+	}
+	else if ((ends(s, "ed") || ends(s, "ing")) && vowelInStem(s)) {
+		s->k = s->j;
+		if (ends(s, "at"))
+			setTo(s, "ate");
+		else if (ends(s, "bl"))
+			setTo(s, "ble");
+		else if (ends(s, "iz"))
+			setTo(s, "ize");
+		else if (doubleConsonant(s, s->k)) {
+			s->k--;
+			if (s->b[s->k] == 'l' || s->b[s->k] == 's' || s->b[s->k] == 'z')
+				s->k++;
+		}
+		else if (measure(s) == 1 && cvc(s, s->k))
+			setTo(s, "e");
+	}
+
+	if (ends(s, "y") && vowelInStem(s))
+		s->b[s->k] = 'i';
+}
+
+/*
+ * Step 2: double suffixes become single ones, as in relational, digitizer, hopefulness.
+ */
+static void step2(stem_t *s) {
+	// Variable declarations.
+	static const char *rules[][2] = {
+		{ "ational", "ate" }, { "tional", "tion" }, { "enci", "ence" }, { "anci", "ance" },
+		{ "izer", "ize" }, { "bli", "ble" }, { "alli", "al" }, { "entli", "ent" }, { "eli", "e" },
+		{ "ousli", "ous" }, { "ization", "ize" }, { "ation", "ate" }, { "ator", "ate" },
+		{ "alism", "al" }, { "iveness", "ive" }, { "fulness", "ful" }, { "ousness", "ous" },
+		{ "aliti", "al" }, { "iviti", "ive" }, { "biliti", "ble" }, { "logi", "log" }, { NULL, NULL }
+	};
+	int32_t i;
+
+	// Rules are tried in order, and only the first whose suffix matches applies.
+	for (i = 0; rules[i][0] != NULL; i++)
+		if (ends(s, rules[i][0])) {
+			replace(s, rules[i][1]);
+			return;
+		}
+}
+
+/*
+ * Step 3: -ic-, -full, -ness and the like, as in triplicate, hopeful, goodness.
+ */
+static void step3(stem_t *s) {
+	// Variable declarations.
+	static const char *rules[][2] = {
+		{ "icate", "ic" }, { "ative", "" }, { "alize", "al" }, { "iciti", "ic" },
+		{ "ical", "ic" }, { "ful", "" }, { "ness", "" }, { NULL, NULL }
+	};
+	int32_t i;
+
+	for (i = 0; rules[i][0] != NULL; i++)
+		if (ends(s, rules[i][0])) {
+			replace(s, rules[i][1]);
+			return;
+		}
+}
+
+/*
+ * Step 4: -ant, -ence and the like come off a stem of two or more sequences, as in
+ * allowance, adjustable, replacement, adoption.
+ */
+static void step4(stem_t *s) {
+	// Variable declarations.
+	static const char *suffixes[] = {
+		"al", "ance", "ence", "er", "ic", "able", "ible", "ant", "ement", "ment", "ent",
+		"ion", "ou", "ism", "ate", "iti", "ous", "ive", "ize", NULL
+	};
+	int32_t i;
+
+	for (i = 0; suffixes[i] != NULL; i++)
+		if (ends(s, suffixes[i])) {
+			// -ion only comes off after an s or a t.
+			if (strcmp(suffixes[i], "ion") == 0 && (s->j < 0 || (s->b[s->j] != 's' && s->b[s->j] != 't')))
+				continue;
+			if (measure(s) > 1)
+				s->k = s->j;
+			return;
+		}
+}
+
+/*
+ * Step 5: a final e, and the second l of a final ll, come off a long enough stem, as in
+ * probate, cease, controll.
+ */
+static void step5(stem_t *s) {
+	// Variable declarations.
+	int32_t m;
+
+	s->j = s->k;
+	if (s->b[s->k] == 'e') {
+		m = measure(s);
+		if (m > 1 || (m == 1 && !cvc(s, s->k - 1)))
+			s->k--;
+	}
+
+	if (s->b[s->k] == 'l' && doubleConsonant(s, s->k) && measure(s) > 1)
+		s->k--;
+}
+
+/*
+ * checks a word, in any case, against the stopwords
+ */
+bool anstop(const char *word, int32_t len, uint32_t hash) {
+	// Variable declarations.
+	const char *stop;
+	int32_t i, slot;
+
+	// Only the stopword that has the word's slot can be the word.
+	if ((slot = stopSlot[(hash*STOPMUL) >> (32 - STOPBITS)]) == 0 || stopHash[slot - 1] != hash)
+		return false;
+
+	// Words are made of letters, so setting bit 5 changes them to lowercase.
+	stop = stopWords[slot - 1];
+	for (i = 0; i < len; i++)
+		if (stop[i] != (word[i] | 0x20))
+			return false;
+
+	return stop[len] == '\0';
+}
+
+/*
+ * reduces a lowercase word to its stem in place
+ */
+int32_t anstem(char *word, int32_t len) {
+	// Variable declarations.
+	stem_t s = { word, len - 1, 0 };
+
+	// Words of one or two letters are left as they are.
+	if (len <= 2)
+		return len;
+
+	step1(&s);
+	if (s.k > 0) {
+		step2(&s);
+		step3(&s);
+		step4(&s);
+		step5(&s);
+	}
+
+	word[s.k + 1] = '\0';
+	return s.k + 1;
+}
+
+/*
+ * analyzes a word found by webpage_getTerms
+ */
+int32_t anterm(const char **text, webpage_term_t *term, char **buf, int32_t *size) {
+#ifdef STEMMING
+	// Variable declarations.
+	char *grown;
+	int32_t i;
+#endif
+
+	if (anstop(*text + term->start, term->len, term->hash))
+		return 1;
+
+#ifdef STEMMING
+	// Make room for the word and its terminator.
+	if (term->len >= *size) {
+		if ((grown = (char *)realloc(*buf, 2*term->len)) == NULL)
+			return -1;
+		*buf = grown;
+		*size = 2*term->len;
+	}
+
+	// Copy the word lowercased, stem it and hash the stem.
+	for (i = 0; i < term->len; i++)
+		(*buf)[i] = (*text)[term->start + i] | 0x20;
+	term->start = 0;
+	term->len = anstem(*buf, term->len);
+	term->hash = webpage_termHash(*buf, term->len);
+	*text = *buf;
+#endif
+
+	return 0;
+}
+
+/*
+ * analyzes a lowercase word in place
+ */
+int32_t anword(char *word) {
+	// Variable declarations.
+	int32_t len = strlen(word);
+
+	if (anstop(word, len, webpage_termHash(word, len)))
+		return 1;
+
+#ifdef STEMMING
+	anstem(word, len);
+#endif
+
+	return 0;
+}
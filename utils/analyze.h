@@ -0,0 +1,47 @@
+#pragma once
+/*
+ * analyze.h --- the analysis words go through before they are indexed or searched for
+ *
+ * Author: Joshua M. Meise
+ * Created: 11-14-2023
+ * Version: 1.0
+ *
+ * Description: Stopwords, the function words that appear on nearly every page, are left out of the
+ *              index, so their postings, which would cover almost every document, are never built or
+ *              ranked. A library built with STEMMING defined ("make STEM=1") also reduces every other
+ *              word to its stem with the Porter stemmer, so that "crawling" and "crawled" are indexed
+ *              and searched for as "crawl". The indexers and the querier go through the same analysis,
+ *              so words are searched for as they were indexed.
+ *
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <webpage.h>
+
+/*
+ * anstop -- checks a word of len letters, in any case, against the stopwords; hash is its
+ * webpage_termHash
+ * returns: true if it is a stopword
+ */
+bool anstop(const char *word, int32_t len, uint32_t hash);
+
+/*
+ * anstem -- reduces a lowercase word of len letters to its stem in place
+ * returns: the length of the stem
+ */
+int32_t anstem(char *word, int32_t len);
+
+/*
+ * anterm -- analyzes a word found by webpage_getTerms in the html at *text; with stemming,
+ * the stem is written to *buf, which holds *size characters and is grown, or allocated if
+ * NULL, as needed, and *text and term are changed to refer to it
+ * returns: 0 if the word is to be indexed; 1 if it is a stopword; -1 if memory runs out
+ */
+int32_t anterm(const char **text, webpage_term_t *term, char **buf, int32_t *size);
+
+/*
+ * anword -- analyzes a lowercase word, as searched for, in place
+ * returns: 0 if the word is to be searched for; 1 if it is a stopword
+ */
+int32_t anword(char *word);
@@ -0,0 +1,247 @@
+/*
+ * arena.c --- implements the arena.h interface
+ *
+ * Author: Joshua M. Meise
+ * Created: 11-15-2023
+ * Version: 1.0
+ *
+ * Description: Memory comes from a list of chunks; allocations are carved from the front of the
+ *              newest one until it is used up. A block too big to leave much of a chunk over gets
+ *              a chunk of its own. Blocks given back are kept on a list for their size, threaded
+ *              through the blocks themselves, and are handed out again before the chunk is used.
+ *
+ */
+
+#include <arena.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Memory taken at a time unless told otherwise.
+#define CHUNKSIZE (1 << 20)
+
+// Everything handed out is aligned to, and a multiple of, this many bytes.
+#define ALIGN (8)
+
+// Sizes of the blocks that can be given back: ALIGN times each power of two below 2^CLASSES.
+#define CLASSES (28)
+
+/* This structure heads every chunk; the memory handed out follows it. */
+typedef struct chunk {
+	struct chunk *next;
+	size_t size;
+} chunk_t;
+
+/* This structure contains the hidden aspects of an arena. */
+typedef struct privatearena {
+	chunk_t *chunks;
+	char *next;
+	char *end;
+	size_t chunkSize;
+	size_t taken;
+	void *freed[CLASSES];
+} privatearena_t;
+
+/*
+ * Finds the list that blocks of a size are given back to.
+ * Outputs: the list's number; -1 if blocks of the size are not kept.
+ */
+static int32_t sizeClass(size_t size) {
+	// Variable declarations.
+	int32_t c;
+
+	if ((size & (size - 1)) != 0)
+		return -1;
+
+	for (c = 0; c < CLASSES && ((size_t)ALIGN << c) != size; c++)
+		;
+
+	return c < CLASSES ? c : -1;
+}
+
+/*
+ * Takes a chunk of memory for size bytes.
+ * Outputs: the chunk, not yet in the arena's list; NULL if memory runs out.
+ */
+static chunk_t *newChunk(size_t size) {
+	// Variable declarations.
+	chunk_t *ch;
+
+	if (size > SIZE_MAX - sizeof(chunk_t) || (ch = (chunk_t *)malloc(sizeof(chunk_t) + size)) == NULL)
+		return NULL;
+
+	ch->next = NULL;
+	ch->size = size;
+	return ch;
+}
+
+/*
+ * aropen -- opens an empty arena
+ * inputs: bytes of memory to take at a time, 0 for a default
+ * outputs: the arena; NULL if memory runs out
+ */
+arena_t *aropen(size_t chunksize) {
+	// Variable declarations.
+	privatearena_t *par;
+
+	if ((par = (privatearena_t *)calloc(1, sizeof(privatearena_t))) == NULL)
+		return NULL;
+
+	par->chunkSize = chunksize == 0 ? CHUNKSIZE : (chunksize + ALIGN - 1) & ~(size_t)(ALIGN - 1);
+	return (arena_t *)par;
+}
+
+/*
+ * arclose -- closes an arena and frees all the memory handed out from it
+ * inputs: arena to close
+ * outputs: none
+ */
+void arclose(arena_t *arp) {
+	// Variable declarations.
+	privatearena_t *par = (privatearena_t *)arp;
+	chunk_t *ch, *next;
+
+	if (par == NULL)
+		return;
+
+	for (ch = par->chunks; ch != NULL; ch = next) {
+		next = ch->next;
+		free(ch);
+	}
+
+	free(par);
+}
+
+/*
+ * aralloc -- hands out memory from an arena
+ * inputs: arena; number of bytes
+ * outputs: pointer to the memory; NULL if memory runs out
+ */
+void *aralloc(arena_t *arp, size_t size) {
+	// Variable declarations.
+	privatearena_t *par = (privatearena_t *)arp;
+	chunk_t *ch;
+	int32_t c;
+	void *p;
+
+	if (par == NULL || size > SIZE_MAX - ALIGN)
+		return NULL;
+
+	size = size == 0 ? ALIGN : (size + ALIGN - 1) & ~(size_t)(ALIGN - 1);
+
+	// A block of the same size that was given back is handed out first.
+	if ((c = sizeClass(size)) >= 0 && par->freed[c] != NULL) {
+		p = par->freed[c];
+		par->freed[c] = *(void **)p;
+		return p;
+	}
+
+	// Most blocks come from what is left of the newest chunk.
+	if (par->next != NULL && size <= (size_t)(par->end - par->next)) {
+		p = par->next;
+		par->next += size;
+		return p;
+	}
+
+	// A big block gets a chunk of its own, behind the newest so that what is left of that is still used.
+	if (size > par->chunkSize/4) {
+		if ((ch = newChunk(size)) == NULL)
+			return NULL;
+		par->taken += sizeof(chunk_t) + size;
+		if (par->chunks == NULL)
+			par->chunks = ch;
+		else {
+			ch->next = par->chunks->next;
+			par->chunks->next = ch;
+		}
+		return ch + 1;
+	}
+
+	// Otherwise the rest of the newest chunk is left unused and a new one started.
+	if ((ch = newChunk(par->chunkSize)) == NULL)
+		return NULL;
+	par->taken += sizeof(chunk_t) + par->chunkSize;
+	ch->next = par->chunks;
+	par->chunks = ch;
+	par->next = (char *)(ch + 1) + size;
+	par->end = (char *)(ch + 1) + par->chunkSize;
+
+	return ch + 1;
+}
+
+/*
+ * arfree -- gives back a block handed out by aralloc
+ * inputs: arena; block; its size as asked for
+ * outputs: none
+ */
+void arfree(arena_t *arp, void *p, size_t size) {
+	// Variable declarations.
+	privatearena_t *par = (privatearena_t *)arp;
+	int32_t c;
+
+	if (par == NULL || p == NULL || size > SIZE_MAX - ALIGN)
+		return;
+
+	size = size == 0 ? ALIGN : (size + ALIGN - 1) & ~(size_t)(ALIGN - 1);
+
+	// Blocks are at least ALIGN bytes, so there is room in one for the link to the next.
+	if ((c = sizeClass(size)) >= 0) {
+		*(void **)p = par->freed[c];
+		par->freed[c] = p;
+	}
+}
+
+/*
+ * arjoin -- moves all the memory of one arena into another and closes the first
+ * inputs: arena to keep; arena to close
+ * outputs: none
+ */
+void arjoin(arena_t *to, arena_t *from) {
+	// Variable declarations.
+	privatearena_t *pto = (privatearena_t *)to, *pfrom = (privatearena_t *)from;
+	chunk_t *ch;
+	void **p;
+	int32_t c;
+
+	if (pto == NULL || pfrom == NULL || pto == pfrom)
+		return;
+
+	// The chunks of from go behind the newest chunk of to; what was left of from's newest is not used again.
+	if (pfrom->chunks != NULL) {
+		for (ch = pfrom->chunks; ch->next != NULL; ch = ch->next)
+			;
+		if (pto->chunks == NULL) {
+			pto->chunks = pfrom->chunks;
+			pto->next = pfrom->next;
+			pto->end = pfrom->end;
+		}
+		else {
+			ch->next = pto->chunks->next;
+			pto->chunks->next = pfrom->chunks;
+		}
+	}
+	pto->taken += pfrom->taken;
+
+	// Blocks given back to from can be handed out by to.
+	for (c = 0; c < CLASSES; c++) {
+		if (pfrom->freed[c] == NULL)
+			continue;
+		for (p = (void **)pfrom->freed[c]; *p != NULL; p = (void **)*p)
+			;
+		*p = pto->freed[c];
+		pto->freed[c] = pfrom->freed[c];
+	}
+
+	free(pfrom);
+}
+
+/*
+ * arbytes -- returns the number of bytes an arena has taken from malloc
+ * inputs: arena
+ * outputs: the bytes of all its chunks; 0 for no arena
+ */
+size_t arbytes(arena_t *arp) {
+	// Variable declarations.
+	privatearena_t *par = (privatearena_t *)arp;
+
+	return par == NULL ? 0 : sizeof(privatearena_t) + par->taken;
+}
@@ -0,0 +1,45 @@
+#pragma once
+/*
+ * arena.h --- public interface to the arena allocator
+ *
+ * Author: Joshua M. Meise
+ * Created: 11-15-2023
+ * Version: 1.0
+ *
+ * Description: An arena hands out memory by bumping a pointer through large chunks, so that
+ *              the many small objects of a structure built once and freed all together, like an
+ *              index's words and postings, cost no malloc each and are freed at once when the
+ *              arena is closed. Blocks whose size is a power of two can be given back and are
+ *              handed out again to the next allocation of that size, which is how arrays that
+ *              double as they grow reuse the memory they leave behind.
+ *
+ */
+
+#include <stddef.h>
+
+/* the arena representation is hidden from users of the module */
+typedef void arena_t;
+
+/* aropen -- opens an empty arena that takes memory chunksize bytes at a time; 0 for a default */
+arena_t *aropen(size_t chunksize);
+
+/* arclose -- closes an arena and frees all the memory handed out from it */
+void arclose(arena_t *arp);
+
+/* aralloc -- hands out size bytes aligned for any type but long double and vector types
+ * returns a pointer to the memory; NULL if memory runs out
+ */
+void *aralloc(arena_t *arp, size_t size);
+
+/* arfree -- gives back a block of size bytes handed out by aralloc; blocks whose size is
+ * not a power of two are only freed when the arena is closed
+ */
+void arfree(arena_t *arp, void *p, size_t size);
+
+/* arjoin -- moves all the memory of from into to and closes from; what was handed out
+ * from either is freed when to is closed
+ */
+void arjoin(arena_t *to, arena_t *from);
+
+/* arbytes -- returns the number of bytes an arena has taken from malloc */
+size_t arbytes(arena_t *arp);
@@ -0,0 +1,282 @@
+/*
+ * checkpoint.c --- implements the checkpoint.h interface
+ *
+ * Author: Joshua M. Meise
+ * Created: 11-06-2023
+ * Version: 1.0
+ *
+ * Description: The snapshot starts with a text header and the next docID, followed by the visited
+ *              set in binary (see ussave) and one "<depth> <url>" line per page still to fetch. It
+ *              is written to a temporary file and renamed into place, so a crash never leaves a
+ *              half-written snapshot behind. Replaying the log is idempotent: a URL queued twice is
+ *              only pending once, and finishing a page that is not pending does nothing.
+ *
+ */
+
+#include <checkpoint.h>
+#include <queue.h>
+#include <pageio.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// Longest line of a snapshot or log: a depth or docID, a space and a URL.
+#define MAXLINE 8192
+
+// First line of every snapshot.
+#define MAGIC "TSE-CHECKPOINT 1"
+
+/* This structure contains the hidden aspects of a checkpoint. */
+typedef struct privatecheckpoint {
+	char *dirnm;
+	FILE *log;
+} privatecheckpoint_t;
+
+// Snapshot being written; used by the function applied to every pending page.
+static FILE *snapfile;
+
+/*
+ * Builds the name of one of the checkpoint files in the page directory.
+ */
+static void fileName(char *name, size_t size, const char *dirnm, const char *file) {
+	snprintf(name, size, "%s/%s", dirnm, file);
+}
+
+/*
+ * Writes one pending page to the snapshot being written.
+ */
+static void writePending(void *elementp) {
+	webpage_t *page = (webpage_t *)elementp;
+
+	fprintf(snapfile, "%d %s\n", webpage_getDepth(page), webpage_getURL(page));
+}
+
+/*
+ * Splits a "<number> <url>" line, dropping its newline.
+ * Inputs: line; where to put the number; where to put a pointer to the URL.
+ * Outputs: 0 for a complete, well formed line; non-zero otherwise.
+ */
+static int32_t splitLine(char *line, int32_t *num, char **url) {
+	// Variable declarations.
+	char *end;
+	size_t len = strlen(line);
+
+	// A line without its newline was cut short by a crash.
+	if (len == 0 || line[len - 1] != '\n')
+		return 1;
+	line[len - 1] = '\0';
+
+	*num = strtol(line, &end, 10);
+	if (*end != ' ' || end[1] == '\0')
+		return 1;
+
+	*url = end + 1;
+	return 0;
+}
+
+/*
+ * opens the checkpoint log of a crawl
+ * inputs: page directory, whether the crawl is being resumed
+ * outputs: the checkpoint, NULL on failure
+ */
+checkpoint_t *cpopen(char *dirnm, bool resume) {
+	// Variable declarations.
+	privatecheckpoint_t *pcp;
+	char name[MAXLINE];
+	struct stat dir;
+
+	// Make sure the page directory exists.
+	if ((stat(dirnm, &dir) != 0 || S_ISDIR(dir.st_mode) == 0) && mkdir(dirnm, 0777) != 0)
+		return NULL;
+
+	if ((pcp = (privatecheckpoint_t *)malloc(sizeof(privatecheckpoint_t))) == NULL)
+		return NULL;
+
+	if ((pcp->dirnm = (char *)malloc(strlen(dirnm) + 1)) == NULL) {
+		free(pcp);
+		return NULL;
+	}
+	strcpy(pcp->dirnm, dirnm);
+
+	// Open the log, keeping what is there only when resuming.
+	fileName(name, sizeof(name), dirnm, ".crawllog");
+	if ((pcp->log = fopen(name, resume ? "a" : "w")) == NULL) {
+		free(pcp->dirnm);
+		free(pcp);
+		return NULL;
+	}
+
+	return (checkpoint_t *)pcp;
+}
+
+/*
+ * closes a checkpoint
+ * inputs: checkpoint to close
+ * outputs: none
+ */
+void cpclose(checkpoint_t *cp) {
+	privatecheckpoint_t *pcp = (privatecheckpoint_t *)cp;
+
+	if (pcp == NULL)
+		return;
+
+	fclose(pcp->log);
+	free(pcp->dirnm);
+	free(pcp);
+}
+
+/*
+ * logs that a page was queued
+ * inputs: checkpoint, page
+ * outputs: 0 for success, non-zero otherwise
+ */
+int32_t cpqueued(checkpoint_t *cp, webpage_t *page) {
+	privatecheckpoint_t *pcp = (privatecheckpoint_t *)cp;
+
+	if (fprintf(pcp->log, "Q %d %s\n", webpage_getDepth(page), webpage_getURL(page)) < 0 || fflush(pcp->log) != 0)
+		return 1;
+
+	return 0;
+}
+
+/*
+ * logs that a page is finished
+ * inputs: checkpoint, page, docID it was saved under or 0
+ * outputs: 0 for success, non-zero otherwise
+ */
+int32_t cpdone(checkpoint_t *cp, webpage_t *page, int32_t id) {
+	privatecheckpoint_t *pcp = (privatecheckpoint_t *)cp;
+
+	if (fprintf(pcp->log, "D %d %s\n", id, webpage_getURL(page)) < 0 || fflush(pcp->log) != 0)
+		return 1;
+
+	return 0;
+}
+
+/*
+ * writes a new snapshot and empties the log
+ * inputs: checkpoint, next docID, visited set, frontier, driver of fetches in flight (or NULL)
+ * outputs: 0 for success, non-zero otherwise
+ */
+int32_t cpsnapshot(checkpoint_t *cp, int32_t nextID, urlset_t *seen, frontier_t *fr, webpage_multi_t *mp) {
+	// Variable declarations.
+	privatecheckpoint_t *pcp = (privatecheckpoint_t *)cp;
+	char tmpName[MAXLINE], name[MAXLINE];
+
+	fileName(tmpName, sizeof(tmpName), pcp->dirnm, ".checkpoint.tmp");
+	fileName(name, sizeof(name), pcp->dirnm, ".checkpoint");
+
+	// Write the whole snapshot to a temporary file.
+	if ((snapfile = fopen(tmpName, "w")) == NULL)
+		return 1;
+
+	fprintf(snapfile, "%s\n%d\n", MAGIC, nextID);
+	if (ussave(seen, snapfile) != 0) {
+		fclose(snapfile);
+		return 1;
+	}
+	frapply(fr, writePending);
+	webpage_multi_apply(mp, writePending);
+
+	if (fclose(snapfile) != 0)
+		return 1;
+
+	// Put it in place of the old one, then start a new log.
+	if (rename(tmpName, name) != 0)
+		return 1;
+
+	fileName(name, sizeof(name), pcp->dirnm, ".crawllog");
+	if ((pcp->log = freopen(name, "w", pcp->log)) == NULL)
+		return 1;
+
+	return 0;
+}
+
+/*
+ * rebuilds a crawl from its checkpoint
+ * inputs: page directory, frontier to fill, where to store the next docID and the visited set
+ * outputs: 0 for success, non-zero if there is no usable checkpoint
+ */
+int32_t cpresume(char *dirnm, frontier_t *fr, int32_t *nextID, urlset_t **seen) {
+	// Variable declarations.
+	char name[MAXLINE], line[MAXLINE], *url;
+	int32_t num, added, result = 0;
+	FILE *ifile;
+	queue_t *pending;
+	urlset_t *finished;
+	webpage_t *page;
+
+	// Read the snapshot header.
+	fileName(name, sizeof(name), dirnm, ".checkpoint");
+	if ((ifile = fopen(name, "r")) == NULL)
+		return 1;
+
+	if (fgets(line, sizeof(line), ifile) == NULL || strcmp(line, MAGIC "\n") != 0 ||
+			fscanf(ifile, "%d", nextID) != 1 || fgetc(ifile) != '\n' || (*seen = usload(ifile)) == NULL) {
+		fclose(ifile);
+		return 1;
+	}
+
+	// Collect the pages that were still to fetch, in order, and apart from them those finished since.
+	pending = qopen();
+	if ((finished = usopen(1000, 0)) == NULL) {
+		fclose(ifile);
+		qclose(pending);
+		usclose(*seen);
+		return 1;
+	}
+
+	while (fgets(line, sizeof(line), ifile) != NULL)
+		if (splitLine(line, &num, &url) == 0)
+			qput(pending, webpage_new(url, num, NULL));
+
+	fclose(ifile);
+
+	// Replay everything logged since the snapshot.
+	fileName(name, sizeof(name), dirnm, ".crawllog");
+	if ((ifile = fopen(name, "r")) != NULL) {
+		while (result == 0 && fgets(line, sizeof(line), ifile) != NULL) {
+			if (line[0] == '\0' || line[1] != ' ' || splitLine(line + 2, &num, &url) != 0)
+				continue;
+
+			// A queued page is pending unless the snapshot already knew about it.
+			if (line[0] == 'Q' && (added = usadd(*seen, url)) != 0) {
+				if (added < 0)
+					result = 1;
+				else
+					qput(pending, webpage_new(url, num, NULL));
+			}
+
+			// A finished page is no longer pending, and a saved one uses up its docID.
+			if (line[0] == 'D') {
+				if (usadd(finished, url) < 0)
+					result = 1;
+				if (num >= *nextID)
+					*nextID = num + 1;
+			}
+		}
+		fclose(ifile);
+	}
+
+	// Pages saved after the last log record made it to disk are finished too.
+	for (; result == 0 && pageexists(*nextID, dirnm); (*nextID)++)
+		if (pageurl(*nextID, dirnm, line, sizeof(line)) == 0 && usadd(finished, line) < 0)
+			result = 1;
+
+	// Hand the pages not finished to the frontier, looking each up once; none if the sets could not hold them.
+	while ((page = (webpage_t *)qget(pending)) != NULL) {
+		if (result != 0 || uscontains(finished, webpage_getURL(page)) == true)
+			webpage_delete(page);
+		else
+			frput(fr, page);
+	}
+
+	qclose(pending);
+	usclose(finished);
+	if (result != 0)
+		usclose(*seen);
+
+	return result;
+}
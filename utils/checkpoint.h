@@ -0,0 +1,63 @@
+#pragma once
+/*
+ * checkpoint.h --- saving and restoring the state of a crawl
+ *
+ * Author: Joshua M. Meise
+ * Created: 11-06-2023
+ * Version: 1.0
+ *
+ * Description: A checkpoint lives next to the saved pages in the page directory and has two parts:
+ *              a snapshot (.checkpoint) holding the next docID, the visited set and every page still
+ *              to be fetched, and an append-only log (.crawllog) of pages queued and finished since
+ *              that snapshot. Logging a record is one short write; taking a snapshot replaces the
+ *              old one atomically and empties the log.
+ *
+ *              Log records are one per line:
+ *                Q <depth> <url>    the page was queued (and its URL marked visited)
+ *                D <docID> <url>    the page is finished: saved as docID, or failed if docID is 0
+ *
+ */
+
+#include <inttypes.h>
+#include <webpage.h>
+#include <frontier.h>
+#include <urlset.h>
+
+/* the checkpoint representation is hidden from users of the module */
+typedef void checkpoint_t;
+
+/*
+ * cpopen -- opens the checkpoint log of the crawl saving pages in dirnm, creating the directory if needed.
+ * A fresh crawl empties any old log; a resumed one appends to it.
+ * returns: the checkpoint, NULL on failure
+ */
+checkpoint_t *cpopen(char *dirnm, bool resume);
+
+/* cpclose -- closes a checkpoint; the files stay on disk */
+void cpclose(checkpoint_t *cp);
+
+/*
+ * cpqueued -- logs that a page was put into the frontier
+ * returns: 0 for success; non-zero otherwise
+ */
+int32_t cpqueued(checkpoint_t *cp, webpage_t *page);
+
+/*
+ * cpdone -- logs that a page is finished, saved under id (0 if it could not be fetched)
+ * returns: 0 for success; non-zero otherwise
+ */
+int32_t cpdone(checkpoint_t *cp, webpage_t *page, int32_t id);
+
+/*
+ * cpsnapshot -- writes a new snapshot and empties the log.
+ * The pages still to fetch are those in the frontier plus those in flight in mp (which may be NULL).
+ * returns: 0 for success; non-zero otherwise
+ */
+int32_t cpsnapshot(checkpoint_t *cp, int32_t nextID, urlset_t *seen, frontier_t *fr, webpage_multi_t *mp);
+
+/*
+ * cpresume -- rebuilds a crawl from the checkpoint in dirnm: the snapshot, then the log, then any
+ * pages found saved in dirnm beyond what the log recorded. Pages still to fetch are put into fr.
+ * returns: 0 for success, setting *nextID and *seen (a new set); non-zero if there is no checkpoint
+ */
+int32_t cpresume(char *dirnm, frontier_t *fr, int32_t *nextID, urlset_t **seen);
@@ -0,0 +1,349 @@
+/*
+ * flathash.c --- implements the flathash.h interface
+ *
+ * Author: Joshua M. Meise
+ * Created: 11-16-2023
+ * Version: 1.0
+ *
+ * Description: Slots are split into groups of 16, each probed as a whole: an entry's hash picks
+ *              the group it starts from, and groups are tried one, two, three... groups further on
+ *              until one has the entry or an empty slot. A slot's control byte is EMPTY, DELETED, or
+ *              the top 7 bits of its entry's hash; entries and their full hashes are kept in arrays
+ *              of their own. A slot whose entry is removed only becomes EMPTY again if its group
+ *              already has an empty slot, since a group with none may have made later entries go on
+ *              to the next one. The table is rebuilt, bigger if it is more than half full of entries,
+ *              once 7/8 of its slots have been used.
+ *
+ */
+
+#include <flathash.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Slots whose control bytes are checked at once.
+#define GROUP (16)
+
+// Control bytes of slots without an entry; those with one are the top 7 bits of its hash, 0 to 127.
+#define EMPTY ((int8_t)-128)
+#define DELETED ((int8_t)-2)
+
+// Most slots a table has.
+#define MAXSLOTS (UINT32_C(1) << 31)
+
+/* This structure contains the hidden aspects of a table. */
+typedef struct privateflathash {
+	int8_t *ctrl;
+	void **entries;
+	uint32_t *hashes;
+	uint32_t size;
+	uint32_t count;
+	uint32_t room;
+} privateflathash_t;
+
+/*
+ * Finds the slots of a group whose control byte is b.
+ * Outputs: a mask with bit i set for each such slot i.
+ */
+static inline uint32_t matchByte(const int8_t *group, int8_t b) {
+#if defined(__SSE2__)
+	return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)group), _mm_set1_epi8(b)));
+#else
+	// Variable declarations.
+	uint32_t mask = 0;
+	int i;
+
+	for (i = 0; i < GROUP; i++)
+		if (group[i] == b)
+			mask |= UINT32_C(1) << i;
+
+	return mask;
+#endif
+}
+
+/*
+ * Finds the slots of a group without an entry, EMPTY or DELETED; theirs are the control bytes with the top bit set.
+ * Outputs: a mask with bit i set for each such slot i.
+ */
+static inline uint32_t matchFree(const int8_t *group) {
+#if defined(__SSE2__)
+	return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)group));
+#else
+	// Variable declarations.
+	uint32_t mask = 0;
+	int i;
+
+	for (i = 0; i < GROUP; i++)
+		if (group[i] < 0)
+			mask |= UINT32_C(1) << i;
+
+	return mask;
+#endif
+}
+
+/*
+ * Gives the control byte of a slot holding an entry with a hash.
+ */
+static inline int8_t tag(uint32_t hash) {
+	return (int8_t)(hash >> 25);
+}
+
+/*
+ * Gives the number of slots to use of a table with size slots before it is rebuilt.
+ */
+static inline uint32_t limit(uint32_t size) {
+	return size - size/8;
+}
+
+/*
+ * Gives a table empty arrays of size slots.
+ * Outputs: 0 for success, non-zero otherwise.
+ */
+static int32_t setup(privateflathash_t *pfh, uint32_t size) {
+	pfh->ctrl = (int8_t *)malloc(size);
+	pfh->entries = (void **)malloc(size*sizeof(void *));
+	pfh->hashes = (uint32_t *)malloc(size*sizeof(uint32_t));
+
+	if (pfh->ctrl == NULL || pfh->entries == NULL || pfh->hashes == NULL) {
+		free(pfh->ctrl);
+		free(pfh->entries);
+		free(pfh->hashes);
+		return 1;
+	}
+
+	memset(pfh->ctrl, EMPTY, size);
+	pfh->size = size;
+	pfh->count = 0;
+	pfh->room = limit(size);
+	return 0;
+}
+
+/*
+ * Finds the slot an entry with a hash goes in: the first without an entry in the groups it is probed through.
+ */
+static uint32_t findFree(privateflathash_t *pfh, uint32_t hash) {
+	// Variable declarations.
+	uint32_t mask = pfh->size - 1, pos = hash & mask & ~(uint32_t)(GROUP - 1), step = 0, open;
+
+	// The table always has an EMPTY slot, so the probe ends.
+	while ((open = matchFree(pfh->ctrl + pos)) == 0) {
+		step += GROUP;
+		pos = (pos + step) & mask;
+	}
+
+	return pos + __builtin_ctz(open);
+}
+
+/*
+ * Finds the slot of an entry.
+ * Outputs: the slot; -1 if the entry is not in the table.
+ */
+static int64_t find(privateflathash_t *pfh, bool (*searchfn)(void* elementp, const void* searchkeyp), const void *key, uint32_t hash) {
+	// Variable declarations.
+	uint32_t mask = pfh->size - 1, pos = hash & mask & ~(uint32_t)(GROUP - 1), step = 0, match, i;
+	int8_t t = tag(hash);
+
+	for (;;) {
+		// Only slots whose control byte and then whole hash match have the search function called on them.
+		for (match = matchByte(pfh->ctrl + pos, t); match != 0; match &= match - 1) {
+			i = pos + __builtin_ctz(match);
+			if (pfh->hashes[i] == hash && searchfn(pfh->entries[i], key))
+				return i;
+		}
+
+		// An entry is never put beyond a group with an empty slot.
+		if (matchByte(pfh->ctrl + pos, EMPTY) != 0)
+			return -1;
+
+		step += GROUP;
+		pos = (pos + step) & mask;
+	}
+}
+
+/*
+ * Puts every entry of a table into new arrays of size slots, leaving out DELETED slots.
+ * Outputs: 0 for success, non-zero otherwise.
+ */
+static int32_t rebuild(privateflathash_t *pfh, uint32_t size) {
+	// Variable declarations.
+	privateflathash_t old = *pfh;
+	uint32_t i, j;
+
+	if (setup(pfh, size) != 0) {
+		*pfh = old;
+		return 1;
+	}
+
+	// Entries keep their hashes, so none is computed again.
+	for (i = 0; i < old.size; i++)
+		if (old.ctrl[i] >= 0) {
+			j = findFree(pfh, old.hashes[i]);
+			pfh->ctrl[j] = old.ctrl[i];
+			pfh->entries[j] = old.entries[i];
+			pfh->hashes[j] = old.hashes[i];
+		}
+	pfh->count = old.count;
+	pfh->room -= old.count;
+
+	free(old.ctrl);
+	free(old.entries);
+	free(old.hashes);
+	return 0;
+}
+
+/*
+ * fhopen -- opens an empty table
+ * inputs: number of entries to size the table for
+ * outputs: the table; NULL if memory runs out
+ */
+flathash_t *fhopen(uint32_t hint) {
+	// Variable declarations.
+	privateflathash_t *pfh;
+	uint32_t size;
+
+	for (size = GROUP; limit(size) < hint && size < MAXSLOTS; size *= 2)
+		;
+
+	if ((pfh = (privateflathash_t *)malloc(sizeof(privateflathash_t))) == NULL)
+		return NULL;
+
+	if (setup(pfh, size) != 0) {
+		free(pfh);
+		return NULL;
+	}
+
+	return (flathash_t *)pfh;
+}
+
+/*
+ * fhclose -- closes a table
+ * inputs: table to close
+ * outputs: none
+ */
+void fhclose(flathash_t *fhp) {
+	// Variable declarations.
+	privateflathash_t *pfh = (privateflathash_t *)fhp;
+
+	if (pfh == NULL)
+		return;
+
+	free(pfh->ctrl);
+	free(pfh->entries);
+	free(pfh->hashes);
+	free(pfh);
+}
+
+/*
+ * fhcount -- returns the number of entries in a table
+ */
+uint32_t fhcount(flathash_t *fhp) {
+	return fhp == NULL ? 0 : ((privateflathash_t *)fhp)->count;
+}
+
+/*
+ * fhbytes -- returns the number of bytes a table takes: a control byte, an entry and a hash for each slot
+ */
+size_t fhbytes(flathash_t *fhp) {
+	// Variable declarations.
+	privateflathash_t *pfh = (privateflathash_t *)fhp;
+
+	if (pfh == NULL)
+		return 0;
+
+	return sizeof(privateflathash_t) + (size_t)pfh->size*(sizeof(int8_t) + sizeof(void *) + sizeof(uint32_t));
+}
+
+/*
+ * fhput -- puts an entry into a table under a hash
+ * inputs: table; entry; its hash
+ * outputs: 0 for success, non-zero otherwise
+ */
+int32_t fhput(flathash_t *fhp, void *ep, uint32_t hash) {
+	// Variable declarations.
+	privateflathash_t *pfh = (privateflathash_t *)fhp;
+	uint32_t i;
+
+	if (pfh == NULL || ep == NULL)
+		return 1;
+
+	// Once 7/8 of the slots have been used, a table half full of entries doubles; otherwise its DELETED slots are cleared.
+	if (pfh->room == 0) {
+		if (pfh->count >= limit(pfh->size)/2 && pfh->size == MAXSLOTS)
+			return 1;
+		if (rebuild(pfh, pfh->count >= limit(pfh->size)/2 ? 2*pfh->size : pfh->size) != 0)
+			return 1;
+	}
+
+	// Filling a DELETED slot leaves the number of EMPTY ones as it was.
+	i = findFree(pfh, hash);
+	if (pfh->ctrl[i] == EMPTY)
+		pfh->room--;
+
+	pfh->ctrl[i] = tag(hash);
+	pfh->entries[i] = ep;
+	pfh->hashes[i] = hash;
+	pfh->count++;
+	return 0;
+}
+
+/*
+ * fhsearch -- searches a table for an entry
+ * inputs: table; search function; key to search for; its hash
+ * outputs: pointer to the entry; NULL if not found
+ */
+void *fhsearch(flathash_t *fhp, bool (*searchfn)(void* elementp, const void* searchkeyp), const void *key, uint32_t hash) {
+	// Variable declarations.
+	privateflathash_t *pfh = (privateflathash_t *)fhp;
+	int64_t i;
+
+	if (pfh == NULL || searchfn == NULL || (i = find(pfh, searchfn, key, hash)) < 0)
+		return NULL;
+
+	return pfh->entries[i];
+}
+
+/*
+ * fhremove -- removes an entry from a table
+ * inputs: table; search function; key to search for; its hash
+ * outputs: pointer to the entry; NULL if not found
+ */
+void *fhremove(flathash_t *fhp, bool (*searchfn)(void* elementp, const void* searchkeyp), const void *key, uint32_t hash) {
+	// Variable declarations.
+	privateflathash_t *pfh = (privateflathash_t *)fhp;
+	int64_t i;
+
+	if (pfh == NULL || searchfn == NULL || (i = find(pfh, searchfn, key, hash)) < 0)
+		return NULL;
+
+	// A group that has never been full has made no entry go on to the next, so its slot can be EMPTY again.
+	if (matchByte(pfh->ctrl + (i & ~(int64_t)(GROUP - 1)), EMPTY) != 0) {
+		pfh->ctrl[i] = EMPTY;
+		pfh->room++;
+	}
+	else
+		pfh->ctrl[i] = DELETED;
+
+	pfh->count--;
+	return pfh->entries[i];
+}
+
+/*
+ * fhapply -- applies a function to every entry in a table
+ * inputs: table; function to apply
+ * outputs: none
+ */
+void fhapply(flathash_t *fhp, void (*fn)(void* ep)) {
+	// Variable declarations.
+	privateflathash_t *pfh = (privateflathash_t *)fhp;
+	uint32_t i;
+
+	if (pfh == NULL || fn == NULL)
+		return;
+
+	for (i = 0; i < pfh->size; i++)
+		if (pfh->ctrl[i] >= 0)
+			fn(pfh->entries[i]);
+}
@@ -0,0 +1,60 @@
+#pragma once
+/*
+ * flathash.h --- public interface to the flat hash table module
+ *
+ * Author: Joshua M. Meise
+ * Created: 11-16-2023
+ * Version: 1.0
+ *
+ * Description: A hash table of entries kept in one array and found by open addressing, in the
+ *              style of Swiss tables: each slot has a byte holding 7 bits of its entry's hash,
+ *              and the bytes of 16 slots are checked against a hash at once, so an entry is
+ *              usually found with one compare of 16 bytes and one call of the search function.
+ *              Entries are put in under a 32-bit hash the caller computes, which is kept with
+ *              them, and the table doubles as it fills without any entry's hash being computed
+ *              again.
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/* the table representation is hidden from users of the module */
+typedef void flathash_t;
+
+/* fhopen -- opens an empty table sized for about hint entries; it grows as needed */
+flathash_t *fhopen(uint32_t hint);
+
+/* fhclose -- closes a table; the entries in it are not freed */
+void fhclose(flathash_t *fhp);
+
+/* fhcount -- returns the number of entries in a table */
+uint32_t fhcount(flathash_t *fhp);
+
+/* fhbytes -- returns the number of bytes a table takes, not counting its entries */
+size_t fhbytes(flathash_t *fhp);
+
+/* fhput -- puts an entry into a table under hash; the entry must not already be in it
+ * returns 0 for success; non-zero otherwise
+ */
+int32_t fhput(flathash_t *fhp, void *ep, uint32_t hash);
+
+/* fhsearch -- searches for an entry put under hash, calling searchfn on the entries whose
+ * hash it is -- returns a pointer to the entry or NULL if not found
+ */
+void *fhsearch(flathash_t *fhp,
+	       bool (*searchfn)(void* elementp, const void* searchkeyp),
+	       const void *key,
+	       uint32_t hash);
+
+/* fhremove -- removes and returns an entry put under hash, found as by fhsearch --
+ * returns a pointer to the entry or NULL if not found
+ */
+void *fhremove(flathash_t *fhp,
+	       bool (*searchfn)(void* elementp, const void* searchkeyp),
+	       const void *key,
+	       uint32_t hash);
+
+/* fhapply -- applies a function to every entry in a table */
+void fhapply(flathash_t *fhp, void (*fn)(void* ep));
@@ -0,0 +1,281 @@
+/*
+ * frontier.c --- implements the frontier.h interface
+ *
+ * Author: Joshua M. Meise
+ * Created: 11-02-2023
+ * Version: 1.0
+ *
+ * Description: Keeps a queue of pages per host in a hash table keyed by host name, plus an
+ *              array of all hosts that frget() walks round-robin. A host is eligible when its
+ *              token bucket holds a whole token and its minimum delay has passed.
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <frontier.h>
+#include <queue.h>
+#include <hash.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* This structure contains the pages waiting for one host and the host's politeness state. */
+typedef struct host {
+	char *name;
+	queue_t *qp;
+	int32_t queued;
+	double tokens;
+	double refilled;
+	double next;
+} host_t;
+
+/* This structure contains the hidden aspects of a frontier. */
+typedef struct privatefrontier {
+	hashtable_t *byName;
+	host_t **hosts;
+	int32_t numHosts;
+	int32_t size;
+	int32_t cursor;
+	int32_t queued;
+	double rate;
+	double burst;
+	double mindelay;
+} privatefrontier_t;
+
+/*
+ * Returns the current time in seconds from a clock that never goes backwards.
+ */
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec/1e9;
+}
+
+/*
+ * This function compares a host name to the name of a host in the hash table.
+ * Inputs: host in hash table; name to search for.
+ * Outputs: true if the names match; false otherwise.
+ */
+static bool searchHost(void *elementp, const void *searchkeyp) {
+	return strcmp(((host_t *)elementp)->name, (const char *)searchkeyp) == 0;
+}
+
+/*
+ * Copies the host part of a URL (everything between "//" and the next '/', '?' or '#') into name.
+ * Inputs: URL; buffer for the host name; size of the buffer.
+ * Outputs: none.
+ */
+static void hostOf(const char *url, char *name, size_t size) {
+	// Variable declarations.
+	const char *beg;
+	size_t len;
+
+	// The host starts after the scheme's "//"; URLs without one all share the empty host.
+	if ((beg = strstr(url, "//")) == NULL) {
+		name[0] = '\0';
+		return;
+	}
+	beg += 2;
+
+	// The host runs up to the start of the path, query or fragment.
+	len = strcspn(beg, "/?#");
+	if (len >= size)
+		len = size - 1;
+
+	memcpy(name, beg, len);
+	name[len] = '\0';
+}
+
+/*
+ * opens an empty frontier
+ * inputs: fetches per second allowed per host, minimum delay between fetches from one host
+ * outputs: pointer to the new frontier, NULL on failure
+ */
+frontier_t *fropen(double rate, double mindelay) {
+	// Variable declarations.
+	privatefrontier_t *pfr;
+
+	// Allocate the frontier.
+	if ((pfr = (privatefrontier_t *)malloc(sizeof(privatefrontier_t))) == NULL)
+		return NULL;
+
+	// Open the table of hosts and start with room for a few of them.
+	pfr->size = 16;
+	if ((pfr->byName = hopen(256)) == NULL || (pfr->hosts = (host_t **)malloc(pfr->size*sizeof(host_t *))) == NULL)
+		return NULL;
+
+	pfr->numHosts = 0;
+	pfr->cursor = 0;
+	pfr->queued = 0;
+	pfr->rate = rate;
+	pfr->mindelay = mindelay;
+
+	// A host may use up to one second's worth of tokens at once, and always at least one.
+	pfr->burst = rate > 1 ? rate : 1;
+
+	return (frontier_t *)pfr;
+}
+
+/*
+ * closes a frontier and frees its hosts; queued pages are not freed
+ * inputs: frontier to close
+ * outputs: none
+ */
+void frclose(frontier_t *frp) {
+	// Variable declarations.
+	privatefrontier_t *pfr = (privatefrontier_t *)frp;
+	int32_t i;
+
+	// Free every host.
+	for (i = 0; i < pfr->numHosts; i++) {
+		qclose(pfr->hosts[i]->qp);
+		free(pfr->hosts[i]->name);
+		free(pfr->hosts[i]);
+	}
+
+	// Free the frontier itself.
+	hclose(pfr->byName);
+	free(pfr->hosts);
+	free(pfr);
+}
+
+/*
+ * queues a page behind the other pages from its host
+ * inputs: frontier, page to queue
+ * outputs: 0 for success, non-zero otherwise
+ */
+int32_t frput(frontier_t *frp, webpage_t *page) {
+	// Variable declarations.
+	privatefrontier_t *pfr = (privatefrontier_t *)frp;
+	char name[256];
+	host_t *hp;
+
+	// Check arguments.
+	if (pfr == NULL || page == NULL)
+		return 1;
+
+	// Find the host the page belongs to.
+	hostOf(webpage_getURL(page), name, sizeof(name));
+
+	// First page from this host: create it with a full bucket.
+	if ((hp = (host_t *)hsearch(pfr->byName, searchHost, name, strlen(name))) == NULL) {
+		if ((hp = (host_t *)malloc(sizeof(host_t))) == NULL || (hp->name = (char *)malloc(strlen(name) + 1)) == NULL)
+			return 1;
+
+		strcpy(hp->name, name);
+		if ((hp->qp = qopen()) == NULL)
+			return 1;
+
+		hp->queued = 0;
+		hp->tokens = pfr->burst;
+		hp->refilled = now();
+		hp->next = 0;
+
+		// Grow the array of hosts if it is full.
+		if (pfr->numHosts == pfr->size) {
+			pfr->size *= 2;
+			if ((pfr->hosts = (host_t **)realloc(pfr->hosts, pfr->size*sizeof(host_t *))) == NULL)
+				return 1;
+		}
+		pfr->hosts[pfr->numHosts++] = hp;
+
+		if (hput(pfr->byName, hp, hp->name, strlen(hp->name)) != 0)
+			return 1;
+	}
+
+	// Queue the page.
+	if (qput(hp->qp, page) != 0)
+		return 1;
+
+	hp->queued++;
+	pfr->queued++;
+
+	return 0;
+}
+
+/*
+ * removes and returns the next page whose host may be fetched now
+ * inputs: frontier, where to store the time until a host becomes eligible
+ * outputs: page to fetch, NULL if none may be fetched now
+ */
+webpage_t *frget(frontier_t *frp, double *wait) {
+	// Variable declarations.
+	privatefrontier_t *pfr = (privatefrontier_t *)frp;
+	double t, hostWait, minWait;
+	int32_t i, j;
+	host_t *hp;
+
+	// Nothing to hand out.
+	if (pfr == NULL || pfr->queued == 0) {
+		*wait = -1;
+		return NULL;
+	}
+
+	t = now();
+	minWait = -1;
+
+	// Walk the hosts once, starting after the one served last.
+	for (i = 0; i < pfr->numHosts; i++) {
+		j = (pfr->cursor + i) % pfr->numHosts;
+		hp = pfr->hosts[j];
+
+		if (hp->queued == 0)
+			continue;
+
+		// Refill the bucket for the time since it was last refilled.
+		if (pfr->rate > 0) {
+			hp->tokens += (t - hp->refilled)*pfr->rate;
+			if (hp->tokens > pfr->burst)
+				hp->tokens = pfr->burst;
+		}
+		hp->refilled = t;
+
+		// Serve this host if it has a token and its delay has passed.
+		if ((pfr->rate <= 0 || hp->tokens >= 1) && t >= hp->next) {
+			if (pfr->rate > 0)
+				hp->tokens -= 1;
+			hp->next = t + pfr->mindelay;
+			hp->queued--;
+			pfr->queued--;
+			pfr->cursor = j + 1;
+			*wait = 0;
+			return (webpage_t *)qget(hp->qp);
+		}
+
+		// Otherwise work out how long until it will be eligible.
+		hostWait = hp->next - t;
+		if (pfr->rate > 0 && (1 - hp->tokens)/pfr->rate > hostWait)
+			hostWait = (1 - hp->tokens)/pfr->rate;
+
+		if (minWait < 0 || hostWait < minWait)
+			minWait = hostWait;
+	}
+
+	*wait = minWait;
+	return NULL;
+}
+
+/*
+ * checks whether any pages are queued
+ * inputs: frontier
+ * outputs: true if no pages are queued
+ */
+bool frempty(frontier_t *frp) {
+	return ((privatefrontier_t *)frp)->queued == 0;
+}
+
+/*
+ * applies a function to every queued page
+ * inputs: frontier, function to apply
+ * outputs: none
+ */
+void frapply(frontier_t *frp, void (*fn)(void *elementp)) {
+	// Variable declarations.
+	privatefrontier_t *pfr = (privatefrontier_t *)frp;
+	int32_t i;
+
+	for (i = 0; i < pfr->numHosts; i++)
+		qapply(pfr->hosts[i]->qp, fn);
+}
@@ -0,0 +1,48 @@
+#pragma once
+/*
+ * frontier.h --- public interface to the crawl frontier module
+ *
+ * Author: Joshua M. Meise
+ * Created: 11-02-2023
+ * Version: 1.0
+ *
+ * Description: A frontier holds the webpages still to be fetched, with one queue per host.
+ *              Each host has a token bucket that refills at a given rate and a minimum delay
+ *              between consecutive fetches, so politeness is enforced per host and pages from
+ *              other hosts never wait behind it. Hosts are served round-robin.
+ *
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <webpage.h>
+
+/* the frontier representation is hidden from users of the module */
+typedef void frontier_t;
+
+/* fropen -- opens an empty frontier
+ * rate -- fetches per second allowed per host (0 for no rate limit);
+ *         a host may burst up to one second's worth of fetches
+ * mindelay -- minimum number of seconds between two fetches from one host
+ */
+frontier_t *fropen(double rate, double mindelay);
+
+/* frclose -- closes a frontier; pages still queued are not freed */
+void frclose(frontier_t *frp);
+
+/* frput -- queues a page behind the other pages from its host
+ * returns 0 for success; non-zero otherwise
+ */
+int32_t frput(frontier_t *frp, webpage_t *page);
+
+/* frget -- removes and returns the next page whose host may be fetched now
+ * returns NULL if no host is eligible; *wait is then set to the number of
+ * seconds until one will be, or to a negative number if the frontier is empty
+ */
+webpage_t *frget(frontier_t *frp, double *wait);
+
+/* frempty -- returns true if no pages are queued */
+bool frempty(frontier_t *frp);
+
+/* frapply -- applies a function to every queued page */
+void frapply(frontier_t *frp, void (*fn)(void *elementp));
@@ -1,23 +1,17 @@
 /* 
- * hash.c -- implements a generic hash table as an indexed set of queues.
+ * hash.c -- implements a generic hash table on a flat hash table (see flathash.h).
  * Josh Meise
  */
 
 #include <stdint.h>
-#include <queue.h>
+#include <flathash.h>
 #include <hash.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
-// Table data structure. Contains size of table (number of slots) and array of queues (one for each slot).
-typedef struct privatehash {
-	uint32_t size;
-	queue_t **thingsInTable;
-} privatehash_t;
-
 /* 
- * SuperFastHash() -- produces a number between 0 and the tablesize-1.
+ * SuperFastHash() -- produces a 32-bit hash of a key.
  * 
  * The following (rather complicated) code, has been taken from Paul
  * Hsieh's website under the terms of the BSD license. It's a hash
@@ -26,7 +20,7 @@ typedef struct privatehash {
  */
 #define get16bits(d) (*((const uint16_t *) (d)))
 
-static uint32_t SuperFastHash (const char *data,int len,uint32_t tablesize) {
+static uint32_t SuperFastHash (const char *data,int len) {
   uint32_t hash = len, tmp;
   int rem;
   
@@ -64,38 +58,16 @@ static uint32_t SuperFastHash (const char *data,int len,uint32_t tablesize) {
   hash += hash >> 17;
   hash ^= hash << 25;
   hash += hash >> 6;
-  return hash % tablesize;
+  return hash;
 }
 
 /* 
  * hopen -- opens a hash table with initial size hsize 
- * inputs: size of hash table (number of slots)
+ * inputs: number of entries to size the table for; it grows as needed
  * outputs: pointer to hash table structure
  */
 hashtable_t *hopen(uint32_t hsize) {
-	// Variable declarations.
-	privatehash_t *table;
-	int32_t i;
-	
-	// Create table by allocating memory.
-	table = (privatehash_t *)malloc(sizeof(privatehash_t));
-	
-	// If the table has been created, initialise its size and a pointer to the items in the table.
-	if (table != NULL) {
-		// Number of slots in table.
-		table->size = hsize;
-
-		// Array to hold queues in table.
-		table->thingsInTable = (queue_t **)malloc(hsize*sizeof(queue_t *));
-
-		// Open a queue at each location in the table.
-		for (i = 0; i < hsize; i++)
-			table->thingsInTable[i] = qopen();
-		
-	}
-	
-	// Return the newly created table.
-	return (hashtable_t*)table;
+	return (hashtable_t *)fhopen(hsize);
 }
 
 /* 
@@ -104,20 +76,7 @@ hashtable_t *hopen(uint32_t hsize) {
  * outputs: none
  */
 void hclose(hashtable_t *htp) {
-	// Variable declarations.
-	int32_t i;
-	privatehash_t *phtp;
-
-	// Coerce into valid datatype.
-	phtp = (privatehash_t *)htp;
-
-	// Close queues at each location.
-	for (i = 0; i < phtp->size; i++)
-		qclose(phtp->thingsInTable[i]);
-
-	// Free array and table structure.
-	free(phtp->thingsInTable);
-	free(phtp);
+	fhclose((flathash_t *)htp);
 }
 
 /* 
@@ -126,25 +85,12 @@ void hclose(hashtable_t *htp) {
  * outputs: 0 for success, nonzero otherwise
  */
 int32_t hput(hashtable_t *htp, void *ep, const char *key, int keylen) {
-	//Variable declarations.
-	privatehash_t *phtp;
-	uint32_t location, success;
-
 	// Check if all arguments are valid.
 	if (htp == NULL || ep == NULL || key == NULL)
 		return 1;
 
-	// Coerce into correct datatype.
-	phtp = (privatehash_t *)htp;
-
-	// Find slot for key.
-	location = SuperFastHash(key, keylen, phtp->size);
-
-	// Put the data into the queue at the corresponding key's location.
-	success = qput(phtp->thingsInTable[location], ep);
-
-	return success;
-	
+	// Put the data into the table under the key's hash.
+	return fhput((flathash_t *)htp, ep, SuperFastHash(key, keylen));
 }
 
 /* 
@@ -153,17 +99,7 @@ int32_t hput(hashtable_t *htp, void *ep, const char *key, int keylen) {
  * outputs: none
  */
 void happly(hashtable_t *htp, void (*fn)(void* ep)) {
- 	// Variable declarations.
-	privatehash_t *phtp;
-	int32_t i;
-
-	// Coerce into correct datatype
-	phtp = (privatehash_t *)htp;
-
-	// Apply the function to each of the queues in the table.
-	for (i = 0; i < phtp->size; i++)
-		qapply(phtp->thingsInTable[i], fn);
-	
+	fhapply((flathash_t *)htp, fn);
 }
 
 /* 
@@ -175,22 +111,7 @@ void happly(hashtable_t *htp, void (*fn)(void* ep)) {
  */
 
 void *hsearch(hashtable_t *htp, bool (*searchfn)(void* elementp, const void* searchkeyp), const char *key, int32_t keylen) {
-	// Variable declarations.
-	privatehash_t *phtp;
-	void *p;
-	int32_t location;
-
-	
-	// Coerce into correct datatype
-	phtp = (privatehash_t *)htp;
-
-	// Find slot in table for the designated key.
-	location = SuperFastHash(key, keylen, phtp->size);
-
-	// Search through the queue at the corresponding lodation.
-	p = qsearch(phtp->thingsInTable[location], searchfn, (const void *)key);
-
-	return p;
+	return fhsearch((flathash_t *)htp, searchfn, (const void *)key, SuperFastHash(key, keylen));
 }
 
 /* 
@@ -201,20 +122,14 @@ void *hsearch(hashtable_t *htp, bool (*searchfn)(void* elementp, const void* sea
  * outputs: pointer to entry that is being searched for
  */
 void *hremove(hashtable_t *htp, bool (*searchfn)(void* elementp, const void* searchkeyp), const char *key, int32_t keylen) {
-	// Variable declarations.
-	privatehash_t *phtp;
-	void *p;
-	int32_t location;
-
-	// Coerce into valid datatype.
-	phtp = (privatehash_t *)htp;
-
-	// Find slot in table for the designated key.
-	location = SuperFastHash(key, keylen, phtp->size);
-
-	// Search through queue to find element to remove at relevant index.
-	p = qremove(phtp->thingsInTable[location], searchfn, (const void *)key);
+	return fhremove((flathash_t *)htp, searchfn, (const void *)key, SuperFastHash(key, keylen));
+}
 
-	return p;
-	
+/*
+ * hhash -- returns the hash of a key that entries are filed under.
+ * Inputs: key; its length.
+ * Outputs: the hash.
+ */
+uint32_t hhash(const char *key, int keylen) {
+	return SuperFastHash(key, keylen);
 }
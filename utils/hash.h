@@ -1,6 +1,6 @@
 #pragma once
 /*
- * lhash.h -- A generic locked hash table implementation, allowing arbitrary
+ * hash.h -- A generic hash table implementation, allowing arbitrary
  * key structures.
  *
  */
@@ -9,7 +9,7 @@
 
 typedef void hashtable_t;	/* representation of a hashtable hidden */
 
-/* hopen -- opens a hash table with initial size hsize */
+/* hopen -- opens a hash table sized for about hsize entries; it grows as needed */
 hashtable_t *hopen(uint32_t hsize);
 
 /* hclose -- closes a hash table */
@@ -40,3 +40,6 @@ void *hremove(hashtable_t *htp,
 	      bool (*searchfn)(void* elementp, const void* searchkeyp), 
 	      const char *key, 
 	      int32_t keylen);
+
+/* hhash -- returns the hash hput, hsearch and hremove file an entry with a key under */
+uint32_t hhash(const char *key, int keylen);
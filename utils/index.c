@@ -0,0 +1,389 @@
+/*
+ * index.c --- implements the index.h interface
+ *
+ * Author: Joshua M. Meise
+ * Created: 11-10-2023
+ * Version: 1.0
+ *
+ * Description: Code shared by everything that builds or reads an index: the indexers, the
+ *              crawler's indexing pipeline and the querier.
+ *
+ */
+
+#include <index.h>
+#include <analyze.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <ctype.h>
+
+// Words taken from a page at a time.
+#define WORDBATCH (256)
+
+// A word of a page being looked up in an index.
+typedef struct term {
+	const char *html;
+	const webpage_term_t *term;
+} term_t;
+
+// Index that indexmergepart is moving entries into, in each thread, and the part of the words it moves.
+static _Thread_local index_t *mergeTo;
+static _Thread_local uint32_t mergePart, mergeParts;
+
+/*
+ * This function compares the current word to one in the hash table.
+ * Inputs: word to search for; word in hash table.
+ * Outputs: true if found in hash table; false if not found in hash table.
+ */
+static bool search(void *elementp, const void *searchkeyp) {
+	// Declare variables and coerce to valid datatypes.
+	wordQ_t *data = (wordQ_t *)elementp;
+	char *searchString = (char *)searchkeyp;
+	char *string = data->word;
+
+	// See if URL passed in is same as relevant URL in hash table.
+	if (strcmp(string, searchString) == 0)
+		return true;
+	else
+		return false;
+
+}
+
+/*
+ * This function compares a word of a page, as found by webpage_getTerms, to one in the hash table.
+ * Inputs: word in hash table; term to search for.
+ * Outputs: true if the term is the word once lowercased; false otherwise.
+ */
+static bool searchTerm(void *elementp, const void *searchkeyp) {
+	// Declare variables and coerce to valid datatypes.
+	wordQ_t *data = (wordQ_t *)elementp;
+	const term_t *key = (const term_t *)searchkeyp;
+	const char *text = key->html + key->term->start;
+	int32_t i;
+
+	// Words in the table are lowercase letters, so setting bit 5 lowercases the term's letters.
+	for (i = 0; i < key->term->len; i++)
+		if (data->word[i] != (text[i] | 0x20))
+			return false;
+
+	return data->word[i] == '\0';
+
+}
+
+/*
+ * Makes room in a word's postings for at least need documents, doubling them as they fill.
+ * Inputs: index; word structure; number of documents to hold.
+ * Outputs: 0 for success; non-zero otherwise.
+ */
+static int32_t grow(index_t *index, wordQ_t *wq, int32_t need) {
+	// Variable declarations.
+	docCount_t *docs;
+	int32_t size;
+
+	if (need <= wq->size)
+		return 0;
+
+	for (size = wq->size == 0 ? 4 : 2*wq->size; size < need; size *= 2)
+		;
+	if ((docs = (docCount_t *)aralloc(index->arena, size*sizeof(docCount_t))) == NULL)
+		return 1;
+
+	// The postings left behind are a power of two in size, so the arena hands them to the next word to grow to it.
+	if (wq->ndocs > 0)
+		memcpy(docs, wq->docs, wq->ndocs*sizeof(docCount_t));
+	arfree(index->arena, wq->docs, wq->size*sizeof(docCount_t));
+
+	wq->docs = docs;
+	wq->size = size;
+	return 0;
+}
+
+/*
+ * Moves one word structure into the index being merged into, if it is in the part being merged.
+ * Inputs: Pointer to a word structure.
+ * Outputs: None.
+ */
+static void moveW(void *data) {
+	// Variable declarations.
+	wordQ_t *wrd = (wordQ_t *)data, *to;
+
+	if (wrd->hash % mergeParts != mergePart)
+		return;
+
+	// A new word moves as it is; otherwise its documents join those already there.
+	if ((to = (wordQ_t *)fhsearch(mergeTo->words, search, wrd->word, wrd->hash)) == NULL) {
+		if (fhput(mergeTo->words, wrd, wrd->hash) != 0)
+			printf("%s not merged.\n", wrd->word);
+	}
+	else {
+		if (grow(mergeTo, to, to->ndocs + wrd->ndocs) != 0)
+			printf("Postings of %s not merged.\n", wrd->word);
+		else {
+			memcpy(to->docs + to->ndocs, wrd->docs, wrd->ndocs*sizeof(docCount_t));
+			to->ndocs += wrd->ndocs;
+		}
+		arfree(mergeTo->arena, wrd->docs, wrd->size*sizeof(docCount_t));
+	}
+}
+
+/*
+ * Copies a word of a page into a buffer, lowercased.
+ * Inputs: page's html; word; buffer, grown as needed; its size.
+ * Outputs: 0 if the word is kept; 1 if it has fewer than 3 characters; -1 if memory runs out.
+ */
+int32_t indexword(const char *html, const webpage_word_t *word, char **buf, int32_t *size) {
+	// Variable declarations.
+	int32_t i;
+	char c, *grown;
+
+	// Words less than 3 characters get discarded.
+	if (word->len < 3)
+		return 1;
+
+	// Make room for the word and its terminator.
+	if (word->len >= *size) {
+		if ((grown = (char *)realloc(*buf, 2*word->len)) == NULL)
+			return -1;
+		*buf = grown;
+		*size = 2*word->len;
+	}
+
+	// Words are made of letters only; change them to lowercase.
+	for (i = 0; i < word->len; i++) {
+		c = html[word->start + i];
+		(*buf)[i] = (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c;
+	}
+	(*buf)[i] = '\0';
+
+	return 0;
+}
+
+/*
+ * Counts one more occurrence of a word of a page in a document.
+ * Inputs: index; page's html; word, with its hash; docID.
+ * Outputs: 0 for success; non-zero otherwise.
+ */
+static int32_t addTerm(index_t *index, const char *html, const webpage_term_t *term, int32_t id) {
+	// Variable declarations.
+	term_t key = { html, term };
+	wordQ_t *wordQueue;
+	int32_t i;
+
+	// If first occurance of word.
+	if ((wordQueue = (wordQ_t *)fhsearch(index->words, searchTerm, &key, term->hash)) == NULL) {
+		// Create a new word structure, and space for the word, in the index's arena.
+		if ((wordQueue = (wordQ_t *)aralloc(index->arena, sizeof(wordQ_t))) == NULL)
+			return 1;
+		if ((wordQueue->word = (char *)aralloc(index->arena, term->len + 1)) == NULL)
+			return 1;
+
+		// Initialise word; words are made of letters only, so setting bit 5 changes them to lowercase.
+		for (i = 0; i < term->len; i++)
+			wordQueue->word[i] = html[term->start + i] | 0x20;
+		wordQueue->word[i] = '\0';
+		wordQueue->hash = term->hash;
+
+		// The word has no documents yet.
+		wordQueue->docs = NULL;
+		wordQueue->ndocs = wordQueue->size = 0;
+
+		// Put word int hash table under the hash it was found with.
+		if (fhput(index->words, wordQueue, term->hash) != 0)
+			return 1;
+	}
+
+	// A page's words are added together, so if the word is already in this document it is the last one in its postings.
+	if (wordQueue->ndocs == 0 || wordQueue->docs[wordQueue->ndocs - 1].doc != id)
+		return indexappend(index, wordQueue, id, 1);
+
+	// Increase the number of occurances in the specified document.
+	wordQueue->docs[wordQueue->ndocs - 1].count++;
+	return 0;
+}
+
+/*
+ * Adds the words of one page to an index.
+ * Inputs: index; page; page's docID.
+ * Outputs: 0 for success; non-zero otherwise.
+ */
+int32_t indexpage(index_t *index, webpage_t *page, int32_t id) {
+	// Variable declarations.
+	webpage_term_t terms[WORDBATCH];
+	const char *html = webpage_getHTML(page), *text;
+	char *stem = NULL;
+	int pos = 0, n, i;
+	int32_t size = 0, kept, result = 0;
+
+	// Words of 3 or more letters are read a batch at a time, hashed as they are found; only new ones are copied.
+	while (result == 0 && (n = webpage_getTerms(page, &pos, terms, WORDBATCH, 3)) > 0) {
+		for (i = 0; i < n && result == 0; i++) {
+			// Stopwords are left out; with stemming, the word's stem is added instead of the word.
+			text = html;
+			if ((kept = anterm(&text, &terms[i], &stem, &size)) < 0)
+				result = 1;
+			else if (kept == 0)
+				result = addTerm(index, text, &terms[i], id);
+		}
+	}
+
+	free(stem);
+	return result;
+}
+
+/*
+ * opens an empty index
+ * inputs: number of slots in its hash table
+ * outputs: the index; NULL if memory runs out
+ */
+index_t *indexopen(uint32_t size) {
+	// Variable declarations.
+	index_t *index;
+
+	if ((index = (index_t *)malloc(sizeof(index_t))) == NULL)
+		return NULL;
+
+	index->words = fhopen(size);
+	index->arena = aropen(0);
+	if (index->words == NULL || index->arena == NULL) {
+		fhclose(index->words);
+		arclose(index->arena);
+		free(index);
+		return NULL;
+	}
+
+	return index;
+}
+
+/*
+ * returns the entry of a word in an index, NULL if not there
+ */
+wordQ_t *indexfind(index_t *index, char *word) {
+	return (wordQ_t *)fhsearch(index->words, search, word, webpage_termHash(word, strlen(word)));
+}
+
+/*
+ * puts an entry for a new word into an index, under the hash its word is looked up by
+ */
+wordQ_t *indexadd(index_t *index, const char *word) {
+	// Variable declarations.
+	wordQ_t *wq;
+	int32_t len = strlen(word);
+
+	if ((wq = (wordQ_t *)aralloc(index->arena, sizeof(wordQ_t))) == NULL ||
+			(wq->word = (char *)aralloc(index->arena, len + 1)) == NULL)
+		return NULL;
+
+	memcpy(wq->word, word, len + 1);
+	wq->hash = webpage_termHash(word, len);
+	wq->docs = NULL;
+	wq->ndocs = wq->size = 0;
+
+	if (fhput(index->words, wq, wq->hash) != 0)
+		return NULL;
+
+	return wq;
+}
+
+/*
+ * adds a document and its count to the end of a word's postings
+ */
+int32_t indexappend(index_t *index, wordQ_t *wq, int32_t id, int32_t count) {
+	if (grow(index, wq, wq->ndocs + 1) != 0)
+		return 1;
+
+	wq->docs[wq->ndocs].doc = id;
+	wq->docs[wq->ndocs].count = count;
+	wq->ndocs++;
+	return 0;
+}
+
+/*
+ * returns the count of a document in a word's postings, NULL if not there
+ */
+docCount_t *indexdoc(wordQ_t *wq, int32_t id) {
+	// Variable declarations.
+	int32_t i;
+
+	// Documents are mostly added in order, and looked for while being added, so the search starts from the end.
+	for (i = wq->ndocs - 1; i >= 0; i--)
+		if (wq->docs[i].doc == id)
+			return &wq->docs[i];
+
+	return NULL;
+}
+
+/*
+ * removes every count of a document from a word's postings
+ */
+void indexdrop(wordQ_t *wq, int32_t id) {
+	// Variable declarations.
+	int32_t i, kept;
+
+	// Keep the other documents in order.
+	for (i = kept = 0; i < wq->ndocs; i++)
+		if (wq->docs[i].doc != id)
+			wq->docs[kept++] = wq->docs[i];
+	wq->ndocs = kept;
+}
+
+/*
+ * moves every entry of one index into another and closes the first
+ * inputs: index to merge into, index to merge from
+ * outputs: none
+ */
+void indexmerge(index_t *to, index_t *from) {
+	indexmergepart(to, from, 0, 1);
+	indexjoin(to, from);
+}
+
+/*
+ * moves the entries of one index whose words are in one part of them into another
+ * inputs: index to merge into, index to merge from, part of the words to move, number of parts
+ * outputs: none
+ */
+void indexmergepart(index_t *to, index_t *from, uint32_t part, uint32_t parts) {
+	mergeTo = to;
+	mergePart = part;
+	mergeParts = parts;
+	fhapply(from->words, moveW);
+}
+
+/*
+ * closes an index whose entries have all been merged into another
+ * inputs: index merged into, index to close
+ * outputs: none
+ */
+void indexjoin(index_t *to, index_t *from) {
+	// The entries of from stay where they are in memory, so its arena becomes part of to's.
+	arjoin(to->arena, from->arena);
+	fhclose(from->words);
+	free(from);
+}
+
+/*
+ * gives the memory an index takes
+ * inputs: index
+ * outputs: bytes of its table and arena
+ */
+size_t indexbytes(index_t *index) {
+	if (index == NULL)
+		return 0;
+
+	// Every entry, word and posting is in the arena, so the table and the arena are all there is.
+	return sizeof(index_t) + fhbytes(index->words) + arbytes(index->arena);
+}
+
+/*
+ * closes an index and frees everything in it
+ * inputs: index to close
+ * outputs: none
+ */
+void indexclose(index_t *index) {
+	if (index == NULL)
+		return;
+
+	// Every entry, word and posting is in the arena.
+	fhclose(index->words);
+	arclose(index->arena);
+	free(index);
+}
@@ -0,0 +1,121 @@
+#pragma once
+/*
+ * index.h --- building an in-memory inverted index
+ *
+ * Author: Joshua M. Meise
+ * Created: 11-10-2023
+ * Version: 1.0
+ *
+ * Description: An index is a hash table from each word to a wordQ_t holding the array of documents
+ *              the word appears in and how many times. The entries, their words and their postings
+ *              are all kept in the index's arena, so building one costs no malloc per word or
+ *              posting and closing one frees them all at once. These functions add the words of a
+ *              page to an index, look words and documents up, merge indexes built separately and
+ *              free them. indexio.h saves and loads the same structure.
+ *
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <flathash.h>
+#include <arena.h>
+#include <webpage.h>
+
+// Structure that contains a document and a number of occurances.
+typedef struct docCount {
+	int doc;
+	int count;
+} docCount_t;
+
+// Structure that contains a word, its webpage_termHash, and its postings: the documents it appears in and number of occurances, in the order added.
+typedef struct wordQ {
+	char *word;
+	uint32_t hash;
+	docCount_t *docs;
+	int32_t ndocs;
+	int32_t size;
+} wordQ_t;
+
+// Structure that contains an index: a hash table of wordQ_t, and the arena they and their words and postings are kept in.
+typedef struct index {
+	flathash_t *words;
+	arena_t *arena;
+} index_t;
+
+/*
+ * indexopen -- opens an empty index whose hash table is sized for about size words
+ * returns: the index; NULL if memory runs out
+ */
+index_t *indexopen(uint32_t size);
+
+/*
+ * indexword -- copies a word of a page, found by webpage_getWords, into *buf lowercased and
+ * terminated; *buf holds *size characters and is grown, or allocated if NULL, as needed
+ * returns: 0 if the word is kept; 1 if it has fewer than 3 characters; -1 if memory runs out
+ */
+int32_t indexword(const char *html, const webpage_word_t *word, char **buf, int32_t *size);
+
+/*
+ * indexpage -- adds every normalized word of a page, less the stopwords and stemmed if the
+ * library stems (see analyze.h), to an index under docID id; the index must not already
+ * hold the document (see indexdrop), as a word's count for it is only looked for at the
+ * end of its postings
+ * returns: 0 for success; non-zero otherwise
+ */
+int32_t indexpage(index_t *index, webpage_t *page, int32_t id);
+
+/* indexfind -- returns the entry of a word in an index, NULL if it is not there */
+wordQ_t *indexfind(index_t *index, char *word);
+
+/*
+ * indexadd -- puts an entry with no documents for a word that is not in an index into it; an
+ * index is keyed by webpage_termHash() of each word, so entries must go in through indexadd or
+ * indexpage rather than fhput
+ * returns: the entry; NULL if memory runs out
+ */
+wordQ_t *indexadd(index_t *index, const char *word);
+
+/*
+ * indexappend -- adds a document and its count to the end of a word's postings
+ * returns: 0 for success; non-zero otherwise
+ */
+int32_t indexappend(index_t *index, wordQ_t *wq, int32_t id, int32_t count);
+
+/*
+ * indexdoc -- returns the count of a document in a word's postings, NULL if it is not there;
+ * the pointer is good until the postings next change
+ */
+docCount_t *indexdoc(wordQ_t *wq, int32_t id);
+
+/* indexdrop -- removes every count of a document from a word's postings */
+void indexdrop(wordQ_t *wq, int32_t id);
+
+/*
+ * indexmerge -- moves every entry of from into to and closes from; the two indexes
+ * must cover different documents
+ */
+void indexmerge(index_t *to, index_t *from);
+
+/*
+ * indexmergepart -- moves into to the entries of from whose words are in part number part
+ * of parts, split by hash; the two indexes must cover different documents. from is only read,
+ * and to's postings only grow in to's arena, so threads can each merge their own part of the
+ * same indexes at once. The entries moved stay in from's memory, and the postings they join
+ * to's are handed to to's arena to reuse, so from must then be closed with indexjoin
+ */
+void indexmergepart(index_t *to, index_t *from, uint32_t part, uint32_t parts);
+
+/*
+ * indexjoin -- closes from, all of whose entries have been merged into to, or into indexes
+ * then merged into to, by indexmergepart; its memory is freed when to is closed
+ */
+void indexjoin(index_t *to, index_t *from);
+
+/*
+ * indexbytes -- returns the number of bytes of memory an index takes, which is what a build
+ * run in bounded memory (see indexspill) checks against its budget
+ */
+size_t indexbytes(index_t *index);
+
+/* indexclose -- closes an index and frees everything in it */
+void indexclose(index_t *index);
@@ -6,12 +6,15 @@
  * Version: 1.0
  * 
  * Description: Contains functions for saving an index to a file and reading an index from a file.
+ *              Spills are merged by keeping the current line of each in a heap ordered by word,
+ *              so each step takes the smallest word and joins the postings of every spill that has it.
  * 
  */
 
-// 
+#define _POSIX_C_SOURCE 200809L
 
 #include <indexio.h>
+#include <index.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
@@ -19,56 +22,26 @@
 // Global variables.
 FILE *ifile;
 
-// Structure that contains a word and a queue that containts documents and number of occurances.
-typedef struct wordQ {
-	char *word;
-	queue_t *qp;
-} wordQ_t;
-
-// Structure that contains a document and a number of occurances.
-typedef struct docCount {
-	int doc;
-	int count;
-} docCount_t;
-
-
-static void printFileQ(void *data) {
-	docCount_t *d = (docCount_t *)data;
-	fprintf(ifile, " %d %d", d->doc, d->count);
-}
-
 static void printFileH(void *data) {
 	wordQ_t *wrd = (wordQ_t *)data;
+	int32_t i;
+
+	// Words whose documents were all removed are left out.
+	if (wrd->ndocs == 0)
+		return;
+
 	fprintf(ifile, "%s", wrd->word);
-	qapply(wrd->qp, printFileQ);
+	for (i = 0; i < wrd->ndocs; i++)
+		fprintf(ifile, " %d %d", wrd->docs[i].doc, wrd->docs[i].count);
 	fprintf(ifile, "\n");
 }
 
-/*
- * This function compares a document ID of a given element to a document ID in the queue.
- * Inputs: docID to search for; docID in queue.
- * Outputs: true if found in queue; false if not found in queue.
- */
-static bool searchQueue(void *elementp, const void *searchkeyp) {
-	// Declare variables and coerce to valid datatypes.
-	docCount_t *data = (docCount_t *)elementp;
-	int *searchVal = (int *)searchkeyp;
-	int comp = data->doc;
-
-	// See if the 2 document IDs are the same.
-	if (comp == *searchVal)
-		return true;
-	else
-		return false;
-	
-}
-
 /*
  * Function to save an index to a file.
  * Inputs: Index to save, name of file to save to.
  * Outputs: 0 for success; non-zero for failure.
  */
-int32_t indexsave(hashtable_t *index, char *indexnm) {
+int32_t indexsave(index_t *index, char *indexnm) {
 	// Check that hash and indexnm exist.
 	if (index == NULL || indexnm == NULL)
 		return 1;
@@ -80,8 +53,8 @@ int32_t indexsave(hashtable_t *index, char *indexnm) {
 	if (access(indexnm, W_OK) != 0)
 		return 1;
 
-	// Write to the file using happly();
-	happly(index, printFileH);
+	// Write to the file using fhapply();
+	fhapply(index->words, printFileH);
 
 	// Close reading file after loop has completed execution.
 	if (fclose(ifile) != 0)
@@ -93,16 +66,16 @@ int32_t indexsave(hashtable_t *index, char *indexnm) {
 /*
  * Function to load an index from a file.
  * Inputs: File name to load from.
- * Outputs: Hash table cotaining index, NULL if failure
+ * Outputs: Index, NULL if failure
  */
-hashtable_t *indexload(char *indexnm) {
+index_t *indexload(char *indexnm) {
 	// Variable declarations.
-	char readWord[50], *str;
-	int32_t i, curID, cnt;
+	char *line = NULL, *str, *next;
+	size_t size = 0;
+	ssize_t len;
+	int32_t curID, cnt;
 	wordQ_t *wordQueue;
-	docCount_t *dc;
-	char ch;
-	hashtable_t *index;
+	index_t *index;
 
 	// Return NULL if no file name passed in.
 	if (indexnm == NULL)
@@ -116,84 +89,322 @@ hashtable_t *indexload(char *indexnm) {
 	if (access(indexnm, R_OK) != 0)
 		return NULL;
 
-	// Open a new hash table.
-	if ((index = hopen(1000)) == NULL)
-		printf("Hash table not opened properly.\n");
+	// Open a new index.
+	if ((index = indexopen(1000)) == NULL) {
+		printf("Index not opened properly.\n");
+		fclose(ifile);
+		return NULL;
+	}
 
-	// First going to read in a word to be added to hash table.
-	i = 0;
+	// Read through file a line at a time, so that a word of any length is read whole.
+	while ((len = getline(&line, &size, ifile)) > 0) {
+		if (line[len - 1] == '\n')
+			line[len - 1] = '\0';
+		else
+			printf("Incorrect character read.\n");
 
-	// Read through file, word by word.
-	while (fscanf(ifile, "%s", readWord) != EOF) {
-		// If the word is the first word in a line.
-		if (i == 0) {
-			// Create a new word structure.
-			if ((wordQueue = (wordQ_t *)malloc(sizeof(wordQ_t))) == NULL)
-				printf("Error in malloc.\n");
+		// Blank lines hold no word.
+		if (line[0] == '\0')
+			continue;
 
-			// Allocate space for word.
-			if ((wordQueue->word = (char *)malloc(strlen(readWord)*sizeof(char) + 1)) == NULL)
-				printf("Error in malloc.\n");
-			
-			// Initialise word.
-			strcpy(wordQueue->word, readWord);
+		// The word ends at the first space.
+		if ((str = strchr(line, ' ')) != NULL)
+			*str++ = '\0';
+		else
+			str = line + strlen(line);
+
+		// Put a new word structure, with no documents yet, into the index.
+		if ((wordQueue = indexadd(index, line)) == NULL) {
+			printf("Unsuccessful put into hash word: %s.\n", line);
+			free(line);
+			indexclose(index);
+			fclose(ifile);
+			return NULL;
+		}
 
-			// Open a queue associated with the word.
-			if ((wordQueue->qp = qopen()) == NULL)
-				printf("Queue not opened correctly.\n");
+		// The rest of the line is pairs of a document ID and a number of occurances.
+		for (;;) {
+			// Extract the document ID, then the count.
+			curID = strtol(str, &next, 10);
+			if (next == str)
+				break;
+			cnt = strtol(next, &str, 10);
+			if (str == next) {
+				printf("Incorrect character read.\n");
+				break;
+			}
+
+			// Add the document/count pair to the end of the word's postings.
+			if (indexappend(index, wordQueue, curID, cnt) != 0)
+				printf("Problem putting docID %d for word %s into postings.\n", curID, wordQueue->word);
+		}
+	}
 
-			// Put word int hash table.
-			if (hput(index, wordQueue, wordQueue->word, strlen(wordQueue->word)) != 0)
-				printf("Unsuccessful put into hash word: %s.\n", wordQueue->word);
+	free(line);
 
-		}
-		// If word being read is a document ID.	
-		else if (i%2 == 1) {
-			// Create a new document/count pair.
-			if ((dc = (docCount_t *)malloc(sizeof(docCount_t))) == NULL)
-				printf("Error on malloc.\n");
-
-			// Extract the document ID.
-			curID = strtol(readWord, &str, 10);
-			
-			// Initialise this new document/count pair.
-			dc->doc = curID;
-
-			// Put document/count pair into queue.
-			if (qput(wordQueue->qp, (void *)dc) != 0)
-				printf("Problem putting docID %d for word %s into queue.\n", curID, wordQueue->word);
+	// Close reading file.
+	if (fclose(ifile) != 0)
+		printf("Error closing file.\n");
+
+	return index;
+
+}
 
+// Entries of the index being spilled by this thread.
+static _Thread_local wordQ_t **spillWords;
+static _Thread_local uint32_t numSpillWords;
+
+// Structure that contains the current line of a spilled file: its word, ended where the postings begin, and its postings.
+typedef struct spill {
+	FILE *file;
+	char *line;
+	size_t size;
+	char *postings;
+	int32_t num;
+} spill_t;
+
+static void collectW(void *data) {
+	wordQ_t *wrd = (wordQ_t *)data;
+
+	// Words whose documents were all removed are left out.
+	if (wrd->ndocs != 0)
+		spillWords[numSpillWords++] = wrd;
+}
+
+static int compareW(const void *a, const void *b) {
+	return strcmp((*(wordQ_t * const *)a)->word, (*(wordQ_t * const *)b)->word);
+}
+
+/*
+ * Function to spill an index to a file, sorted by word.
+ * Inputs: Index to spill, name of file to spill to.
+ * Outputs: 0 for success; non-zero for failure.
+ */
+int32_t indexspill(index_t *index, char *spillnm) {
+	// Variable declarations.
+	FILE *sfile;
+	uint32_t i;
+	int32_t j, result = 0;
+
+	// Check that index and spillnm exist.
+	if (index == NULL || spillnm == NULL)
+		return 1;
+
+	// Gather the entries and sort them by word.
+	if ((spillWords = (wordQ_t **)malloc(sizeof(wordQ_t *)*(fhcount(index->words) + 1))) == NULL)
+		return 1;
+	numSpillWords = 0;
+	fhapply(index->words, collectW);
+	qsort(spillWords, numSpillWords, sizeof(wordQ_t *), compareW);
+
+	// Open the file for writing.
+	if ((sfile = fopen(spillnm, "w")) == NULL) {
+		free(spillWords);
+		return 1;
+	}
+
+	for (i = 0; i < numSpillWords; i++) {
+		fprintf(sfile, "%s", spillWords[i]->word);
+		for (j = 0; j < spillWords[i]->ndocs; j++)
+			fprintf(sfile, " %d %d", spillWords[i]->docs[j].doc, spillWords[i]->docs[j].count);
+		fprintf(sfile, "\n");
+	}
+
+	// A full disk only shows when the file is closed.
+	if (ferror(sfile) || fclose(sfile) != 0)
+		result = 1;
+
+	free(spillWords);
+	return result;
+}
+
+/*
+ * Reads the next line of a spilled file, splitting it into its word and postings.
+ * Inputs: Spilled file.
+ * Outputs: 0 for success; non-zero at the end of the file.
+ */
+static int32_t nextLine(spill_t *sp) {
+	// Variable declarations.
+	ssize_t len;
+	char *space;
+
+	if ((len = getline(&(sp->line), &(sp->size), sp->file)) <= 0)
+		return 1;
+
+	if (sp->line[len - 1] == '\n')
+		sp->line[len - 1] = '\0';
+
+	// The postings start after the first space, if there are any.
+	if ((space = strchr(sp->line, ' ')) != NULL) {
+		*space = '\0';
+		sp->postings = space + 1;
+	}
+	else
+		sp->postings = sp->line + strlen(sp->line);
+
+	return 0;
+}
+
+/*
+ * Tells whether one spill's line comes before another's: by word, then by the order the spills were given.
+ */
+static bool before(spill_t *a, spill_t *b) {
+	// Variable declarations.
+	int c = strcmp(a->line, b->line);
+
+	return c < 0 || (c == 0 && a->num < b->num);
+}
+
+/*
+ * Moves the spill at the top of a heap down until it is before both of the spills under it.
+ */
+static void siftDown(spill_t **heap, int32_t n) {
+	// Variable declarations.
+	int32_t i = 0, child;
+	spill_t *sp;
+
+	while ((child = 2*i + 1) < n) {
+		if (child + 1 < n && before(heap[child + 1], heap[child]))
+			child++;
+		if (!before(heap[child], heap[i]))
+			break;
+		sp = heap[i];
+		heap[i] = heap[child];
+		heap[child] = sp;
+		i = child;
+	}
+}
+
+/*
+ * Moves the spill at the end of a heap of n up until it is after the spill over it.
+ */
+static void siftUp(spill_t **heap, int32_t n) {
+	// Variable declarations.
+	int32_t i = n - 1, parent;
+	spill_t *sp;
+
+	while (i > 0 && before(heap[i], heap[parent = (i - 1)/2])) {
+		sp = heap[i];
+		heap[i] = heap[parent];
+		heap[parent] = sp;
+		i = parent;
+	}
+}
+
+/*
+ * Writes the postings of a spill's line that are kept, after the word if none of its postings has been written yet.
+ * Inputs: File to write to, the word, the spill, function keeping documents or NULL for all, whether the word has been written.
+ * Outputs: None.
+ */
+static void writePostings(FILE *ofile, char *word, spill_t *sp, bool (*keepfn)(int32_t spill, int32_t doc), bool *started) {
+	// Variable declarations.
+	char *p, *end;
+	long doc, count;
+
+	// With every document kept, the postings are copied as they are.
+	if (keepfn == NULL) {
+		if (sp->postings[0] == '\0')
+			return;
+		if (*started == false)
+			fprintf(ofile, "%s", word);
+		fprintf(ofile, " %s", sp->postings);
+		*started = true;
+		return;
+	}
+
+	for (p = sp->postings; ; p = end) {
+		doc = strtol(p, &end, 10);
+		if (end == p)
+			return;
+		count = strtol(p = end, &end, 10);
+		if (end == p)
+			return;
+
+		if (keepfn(sp->num, (int32_t)doc)) {
+			if (*started == false)
+				fprintf(ofile, "%s", word);
+			fprintf(ofile, " %ld %ld", doc, count);
+			*started = true;
 		}
-		// If word being read is a number of occurances. 
-		else {
-			// Find corresponding document in queue.
-			dc = (docCount_t *)qsearch(wordQueue->qp, searchQueue, (void *)&curID);
+	}
+}
+
+/*
+ * Function to merge spilled files into one index file.
+ * Inputs: Names of the spilled files, number of them, name of file to save to, function keeping documents.
+ * Outputs: 0 for success; non-zero for failure.
+ */
+int32_t indexmergespills(char **spillnms, int32_t numSpills, char *indexnm, bool (*keepfn)(int32_t spill, int32_t doc)) {
+	// Variable declarations.
+	FILE *ofile;
+	spill_t *spills, **heap, *top;
+	int32_t i, n = 0, result = 0;
+	char *word = NULL, *grown;
+	size_t wordSize = 0;
+	bool started;
+
+	// Check that the names exist.
+	if (spillnms == NULL || numSpills < 0 || indexnm == NULL)
+		return 1;
 
-			// Extract the count.
-			cnt = strtol(readWord, &str, 10);
+	spills = (spill_t *)calloc(numSpills + 1, sizeof(spill_t));
+	heap = (spill_t **)malloc(sizeof(spill_t *)*(numSpills + 1));
+	if (spills == NULL || heap == NULL || (ofile = fopen(indexnm, "w")) == NULL) {
+		free(spills);
+		free(heap);
+		return 1;
+	}
 
-			// Put associated count into queue.
-			dc->count = cnt;
+	// Open each spill and put its first line in the heap.
+	for (i = 0; i < numSpills && result == 0; i++) {
+		spills[i].num = i;
+		if ((spills[i].file = fopen(spillnms[i], "r")) == NULL)
+			result = 1;
+		else if (nextLine(spills + i) == 0) {
+			heap[n++] = spills + i;
+			siftUp(heap, n);
 		}
+	}
 
-		// Read in space/newline character.
-		ch = getc(ifile);
+	// Take the smallest word, then the postings of every spill with the same word, in the order of the spills.
+	while (result == 0 && n > 0) {
+		// The buffer is only replaced once it has grown, so that it is still freed if memory runs out.
+		if (wordSize <= strlen(heap[0]->line)) {
+			if ((grown = (char *)realloc(word, strlen(heap[0]->line) + 1)) == NULL) {
+				result = 1;
+				break;
+			}
+			word = grown;
+			wordSize = strlen(heap[0]->line) + 1;
+		}
+		strcpy(word, heap[0]->line);
+		started = false;
 
-		// If space increment i, if newline, set i back to 0.
-		if (ch == ' ')
-			i++;
-		else if (ch == '\n')
-			i = 0;
-		else
-			printf("Incorrect character read.\n");
-			
+		while (n > 0 && strcmp(heap[0]->line, word) == 0) {
+			top = heap[0];
+			writePostings(ofile, word, top, keepfn, &started);
+
+			// A spill that has run out leaves the heap.
+			if (nextLine(top) != 0)
+				heap[0] = heap[--n];
+			siftDown(heap, n);
+		}
+		if (started)
+			fprintf(ofile, "\n");
 	}
-		
 
-	// Close reading file.
-	if (fclose(ifile) != 0)
-		printf("Error closing file.\n");
+	// Close every spill.
+	for (i = 0; i < numSpills; i++) {
+		if (spills[i].file != NULL)
+			fclose(spills[i].file);
+		free(spills[i].line);
+	}
 
-	return index;
+	if (ferror(ofile) || fclose(ofile) != 0)
+		result = 1;
 
+	free(word);
+	free(spills);
+	free(heap);
+	return result;
 }
@@ -7,25 +7,44 @@
  * Version: 1.0
  * 
  * Description: Contains functions to save an index to a file and read an index from a file.
+ *              An index too big for memory is built in pieces instead: each piece is spilled to a
+ *              file of its own, with its words in sorted order, and the spills are merged into the
+ *              index file in one pass that holds only a line of each in memory at a time.
  * 
  */
 
 #include <inttypes.h>
-#include <hash.h>
 #include <stdio.h>
-#include <queue.h>
+#include <index.h>
 
 /*
  * Function to save an index to a file.
  * Inputs: Index to save, name of file to save to.
  * Outputs: 0 for success; non-zero for failure.
  */
-int32_t indexsave(hashtable_t *index, char *indexnm);
+int32_t indexsave(index_t *index, char *indexnm);
 
 /*
  * Function to load an index from a file.
  * Inputs: File name to load from.
- * Outputs: Hash table cotaining index, NULL if failure
+ * Outputs: Index, NULL if failure
  */
-hashtable_t *indexload(char *indexnm);
+index_t *indexload(char *indexnm);
 
+/*
+ * Function to spill an index to a file in the index file format, with its words in sorted order
+ * and each word's documents in the order they were added.
+ * Inputs: Index to spill, name of file to spill to.
+ * Outputs: 0 for success; non-zero for failure.
+ */
+int32_t indexspill(index_t *index, char *spillnm);
+
+/*
+ * Function to merge the files spilled from indexes over different documents into one index file.
+ * A word's documents from each spill follow each other in the order the spills are given, and the
+ * words of the index file are in sorted order. If keepfn is not NULL, only the documents it keeps,
+ * given the number of their spill in that order, are merged, and words left with none are dropped.
+ * Inputs: Names of the spilled files, number of them, name of file to save to, function keeping documents.
+ * Outputs: 0 for success; non-zero for failure.
+ */
+int32_t indexmergespills(char **spillnms, int32_t numSpills, char *indexnm, bool (*keepfn)(int32_t spill, int32_t doc));
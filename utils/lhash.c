@@ -1,182 +1,285 @@
-/* 
- * hash.c -- implements a generic hash table as an indexed set of queues.
+/*
+ * lhash.c -- implements a generic locked hash table as a set of separately locked flat hash tables.
  * Josh Meise
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdint.h>
 #include <hash.h>
+#include <flathash.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <pthread.h>
 #include <lhash.h>
 
+// Number of stripes an entry's hash spreads the entries over, each with a table and lock of its own.
+#define STRIPEBITS (6)
+#define STRIPES (1 << STRIPEBITS)
+
+// Bytes in a cache line; stripes are kept in lines of their own, so locking one does not slow the others.
+#define LINE (64)
+
+/*
+ * This structure contains one stripe of a locked hash table: the entries whose hashes
+ * pick it, and a lock that any number of searches may hold at once, or one change.
+ */
+typedef struct stripe {
+	_Alignas(LINE) pthread_rwlock_t lock;
+	flathash_t *table;
+} stripe_t;
+
 /*
  * This structure contains the hidden aspcents of a locked hash table.
- * Each locked hash table contains a hash table and an associated mutex.
+ * Each locked hash table contains its stripes.
  */
 typedef struct privatelhash {
-	hashtable_t *hash;
-	pthread_mutex_t m;
+	stripe_t stripes[STRIPES];
 } privatelhash_t;
 
-/* 
- * lhopen -- opens a locked hash table with initial size hsize 
- * inputs: size of hash table (number of slots)
+/*
+ * Picks the stripe of a hash. The tables use the low bits of a hash to place an entry and the high
+ * ones to tell entries apart, so the stripe comes from a multiple of the hash that mixes all its bits.
+ */
+static inline stripe_t *stripeOf(privatelhash_t *lphtp, uint32_t hash) {
+	return &lphtp->stripes[(hash*UINT32_C(0x9e3779b1)) >> (32 - STRIPEBITS)];
+}
+
+/*
+ * lhopen -- opens a locked hash table with initial size hsize
+ * inputs: number of entries to size the table for; it grows as needed
  * outputs: pointer to locked hash table structure
  */
 lhashtable_t *lhopen(uint32_t hsize) {
 	// Variable declarations.
 	privatelhash_t *table;
-	
-	// Create table by allocating memory.
-	table = (privatelhash_t *)malloc(sizeof(privatelhash_t));
-	
-	// If the table has been created, open its associated hash table and mutex.
-	if (table != NULL)
-		// Open hash table and initialise associated mutex.
-		if ((table->hash = hopen(hsize)) == NULL || pthread_mutex_init(&(table->m), NULL) != 0)
+	int32_t i;
+
+	// Create table by allocating memory aligned for its stripes.
+	if ((table = (privatelhash_t *)aligned_alloc(LINE, sizeof(privatelhash_t))) == NULL)
+		return NULL;
+
+	// Open each stripe's table and initialise its lock.
+	for (i = 0; i < STRIPES; i++) {
+		if ((table->stripes[i].table = fhopen(hsize/STRIPES)) == NULL || pthread_rwlock_init(&(table->stripes[i].lock), NULL) != 0) {
+			fhclose(table->stripes[i].table);
+			while (--i >= 0) {
+				fhclose(table->stripes[i].table);
+				pthread_rwlock_destroy(&(table->stripes[i].lock));
+			}
+			free(table);
 			return NULL;
-	
+		}
+	}
+
 	// Return the newly created locked table.
 	return (lhashtable_t*)table;
 }
 
-/* 
+/*
  * lhclose -- closes a locked hash table and frees all memory associated with it
- * inputs: table to close 
+ * inputs: table to close
  * outputs: none
  */
 void lhclose(lhashtable_t *lhtp) {
 	// Variable declarations.
 	privatelhash_t *lphtp;
+	int32_t i;
 
 	// Coerce into valid datatype.
 	lphtp = (privatelhash_t *)lhtp;
 
-	// Close associated hash table.
-	hclose(lphtp->hash);
-	
-	// Destroy the mutex.
-	pthread_mutex_destroy(&(lphtp->m));
-	
+	if (lphtp == NULL)
+		return;
+
+	// Close each stripe's table and destroy its lock.
+	for (i = 0; i < STRIPES; i++) {
+		fhclose(lphtp->stripes[i].table);
+		pthread_rwlock_destroy(&(lphtp->stripes[i].lock));
+	}
+
 	// Free locked hash structure.
 	free(lphtp);
-	
+
 }
 
-/* 
- * lhput -- puts an entry into a locked hash table under designated key
- * inputs: table into which to insert, element to place in table, key associated with element, length of the key
- * outputs: 0 for success, nonzero otherwise
+/*
+ * lhputh -- puts an entry into a locked hash table under a hash the caller has already computed
+ * inputs: table, entry, hash of its key
+ * outputs: 0 for success; non-zero otherwise
  */
-int32_t lhput(lhashtable_t *lhtp, void *ep, const char *key, int keylen) {
-	//Variable declarations.
-	privatelhash_t *lphtp;
+int32_t lhputh(lhashtable_t *lhtp, void *ep, uint32_t hash) {
+	// Variable declarations.
+	stripe_t *s;
+	int32_t result;
 
 	// Check if all arguments are valid.
-	if (lhtp == NULL || ep == NULL || key == NULL)
+	if (lhtp == NULL || ep == NULL)
 		return 1;
 
-	// Coerce into correct datatype.
-	lphtp = (privatelhash_t *)lhtp;
-
-	// Lock the mutex associated with the locked hash.
-	if (pthread_mutex_lock(&(lphtp->m)) != 0)
-		return 1;
-	
-	// Put into hash table.
-	if (hput(lphtp->hash, ep, key, keylen) != 0)
+	// Lock the stripe for the change.
+	s = stripeOf((privatelhash_t *)lhtp, hash);
+	if (pthread_rwlock_wrlock(&(s->lock)) != 0)
 		return 1;
-	
-	// Unlock mutex.
-	if (pthread_mutex_unlock(&(lphtp->m)) != 0)
+
+	// Put into the stripe's table.
+	result = fhput(s->table, ep, hash);
+
+	// Unlock the stripe.
+	if (pthread_rwlock_unlock(&(s->lock)) != 0)
 		return 1;
 
-	return 0;
-	
+	return result;
+
 }
 
-/* 
- * lhapply -- applies a function to every entry in locked hash table
- * inputs: table to which to apply function, function to apply
- * outputs: none
+/*
+ * lhsearchh -- searches a locked hash table for an entry under a hash the caller has already computed
+ * inputs: table to search, search function, key to search for, hash of the key
+ * outputs: pointer to entry that is being searched for, NULL if not found
  */
-void lhapply(lhashtable_t *lhtp, void (*fn)(void* ep)) {
- 	// Variable declarations.
-	privatelhash_t *lphtp;
+void *lhsearchh(lhashtable_t *lhtp, bool (*searchfn)(void* elementp, const void* searchkeyp), const void *key, uint32_t hash) {
+	// Variable declarations.
+	stripe_t *s;
+	void *data;
 
-	// Coerce into correct datatype
-	lphtp = (privatelhash_t *)lhtp;
+	if (lhtp == NULL)
+		return NULL;
+
+	// Lock the stripe for searching; other searches of it go on at the same time.
+	s = stripeOf((privatelhash_t *)lhtp, hash);
+	if (pthread_rwlock_rdlock(&(s->lock)) != 0)
+		return NULL;
+
+	// Search the stripe's table.
+	data = fhsearch(s->table, searchfn, key, hash);
+
+	// Unlock the stripe.
+	if (pthread_rwlock_unlock(&(s->lock)) != 0)
+		return NULL;
 
-	// Lock the mutex associated with the locked hash table.
-	pthread_mutex_lock(&(lphtp->m));
+	return data;
 
-	// Apply function to associated hash table.
-	happly(lphtp->hash, fn);
-	
-	// Unlock mutex.
-	pthread_mutex_unlock(&(lphtp->m));
- 
 }
 
-/* 
- * lhsearch -- searches for an entry under a designated key using a
- * designated search fn -- returns a pointer to the entry or NULL if
- * not found
- * inputs: table to search, search function, key to search for, length of the key
- * outputs: pointer to entry that is being searched for
+/*
+ * lhsearchputh -- searches a locked hash table for an entry under a hash the caller has already
+ * computed, and puts one made for the key if there is none, as one step
+ * inputs: table, search function, key to search for, hash of the key, function making an entry for the key
+ * outputs: pointer to the entry found or put, NULL if none was made or it could not be put
  */
+void *lhsearchputh(lhashtable_t *lhtp, bool (*searchfn)(void* elementp, const void* searchkeyp), const void *key, uint32_t hash, void *(*makefn)(const void *key)) {
+	// Variable declarations.
+	stripe_t *s;
+	void *data;
 
-void *lhsearch(lhashtable_t *lhtp, bool (*searchfn)(void* elementp, const void* searchkeyp), const char *key, int32_t keylen) {
- 	// Variable declarations.
-	privatelhash_t *lphtp;
+	// Most keys are already there, and are found without keeping other threads out of the stripe.
+	if ((data = lhsearchh(lhtp, searchfn, key, hash)) != NULL || lhtp == NULL || makefn == NULL)
+		return data;
+
+	// Lock the stripe for the change.
+	s = stripeOf((privatelhash_t *)lhtp, hash);
+	if (pthread_rwlock_wrlock(&(s->lock)) != 0)
+		return NULL;
+
+	// Another thread may have put the key in since the search; otherwise put the new entry in before anyone else can.
+	if ((data = fhsearch(s->table, searchfn, key, hash)) == NULL && (data = makefn(key)) != NULL && fhput(s->table, data, hash) != 0)
+		data = NULL;
+
+	// Unlock the stripe.
+	if (pthread_rwlock_unlock(&(s->lock)) != 0)
+		return NULL;
+
+	return data;
+
+}
+
+/*
+ * lhremoveh -- removes and returns an entry under a hash the caller has already computed
+ * inputs: table to search, search function, key to search for, hash of the key
+ * outputs: pointer to entry that was removed, NULL if not found
+ */
+void *lhremoveh(lhashtable_t *lhtp, bool (*searchfn)(void* elementp, const void* searchkeyp), const void *key, uint32_t hash) {
+	// Variable declarations.
+	stripe_t *s;
 	void *data;
 
-	// Coerce into correct datatype
-	lphtp = (privatelhash_t *)lhtp;
+	if (lhtp == NULL)
+		return NULL;
 
-	// Lock the mutex associated with the locked hash table.
-	if ((pthread_mutex_lock(&(lphtp->m))) != 0)
+	// Lock the stripe for the change.
+	s = stripeOf((privatelhash_t *)lhtp, hash);
+	if (pthread_rwlock_wrlock(&(s->lock)) != 0)
 		return NULL;
-	
-	// Search the associated hash table.
-	data = hsearch(lphtp->hash, searchfn, key, keylen);
-	
-	// Unlock mutex.
-	if ((pthread_mutex_unlock(&(lphtp->m))) != 0)
+
+	// Remove from the stripe's table.
+	data = fhremove(s->table, searchfn, key, hash);
+
+	// Unlock the stripe.
+	if (pthread_rwlock_unlock(&(s->lock)) != 0)
 		return NULL;
 
 	return data;
 
 }
 
-/* 
+/*
+ * lhput -- puts an entry into a locked hash table under designated key
+ * inputs: table into which to insert, element to place in table, key associated with element, length of the key
+ * outputs: 0 for success, nonzero otherwise
+ */
+int32_t lhput(lhashtable_t *lhtp, void *ep, const char *key, int keylen) {
+	// Check if all arguments are valid.
+	if (lhtp == NULL || ep == NULL || key == NULL)
+		return 1;
+
+	return lhputh(lhtp, ep, hhash(key, keylen));
+}
+
+/*
+ * lhsearch -- searches for an entry under a designated key using a
+ * designated search fn -- returns a pointer to the entry or NULL if
+ * not found
+ * inputs: table to search, search function, key to search for, length of the key
+ * outputs: pointer to entry that is being searched for
+ */
+void *lhsearch(lhashtable_t *lhtp, bool (*searchfn)(void* elementp, const void* searchkeyp), const char *key, int32_t keylen) {
+	return lhsearchh(lhtp, searchfn, key, hhash(key, keylen));
+}
+
+/*
  * lhremove -- removes and returns an entry under a designated key
  * using a designated search fn -- returns a pointer to the entry or
  * NULL if not found
  * inputs: table to search, search function, key to search for, length of the key
  * outputs: pointer to entry that is being searched for
  */
-void *lhremove(hashtable_t *lhtp, bool (*searchfn)(void* elementp, const void* searchkeyp), const char *key, int32_t keylen) {
+void *lhremove(lhashtable_t *lhtp, bool (*searchfn)(void* elementp, const void* searchkeyp), const char *key, int32_t keylen) {
+	return lhremoveh(lhtp, searchfn, key, hhash(key, keylen));
+}
+
+/*
+ * lhapply -- applies a function to every entry in locked hash table
+ * inputs: table to which to apply function, function to apply
+ * outputs: none
+ */
+void lhapply(lhashtable_t *lhtp, void (*fn)(void* ep)) {
  	// Variable declarations.
 	privatelhash_t *lphtp;
-	void *data;
+	int32_t i;
 
 	// Coerce into correct datatype
 	lphtp = (privatelhash_t *)lhtp;
 
-	// Lock the mutex associated with the locked hash table.
-	if ((pthread_mutex_lock(&(lphtp->m))) != 0)
-		return NULL;
+	if (lphtp == NULL)
+		return;
 
-	// Search the associated hash table.
-	data = hremove(lphtp->hash, searchfn, key, keylen);
-	
-	// Unlock mutex.
-	if ((pthread_mutex_unlock(&(lphtp->m))) != 0)
-		return NULL;
+	// Apply the function to one stripe at a time, keeping other threads out of the stripe while it runs.
+	for (i = 0; i < STRIPES; i++) {
+		pthread_rwlock_wrlock(&(lphtp->stripes[i].lock));
+		fhapply(lphtp->stripes[i].table, fn);
+		pthread_rwlock_unlock(&(lphtp->stripes[i].lock));
+	}
 
-	return data;
-	
 }
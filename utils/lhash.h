@@ -1,6 +1,10 @@
 #pragma once
 /*
- * hash.h -- A generic locked hash table implementation.
+ * lhash.h -- A generic locked hash table implementation.
+ *
+ * Entries are spread by hash over stripes, each a table with a lock of its
+ * own, so threads working on different entries rarely wait for each other,
+ * and searches of the same stripe go on at the same time.
  *
  */
 
@@ -9,13 +13,13 @@
 
 typedef void lhashtable_t;	/* representation of a hashtable hidden */
 
-/* lhopen -- opens a hash table with initial size hsize */
+/* lhopen -- opens a hash table sized for about hsize entries; it grows as needed */
 lhashtable_t *lhopen(uint32_t hsize);
 
 /* lhclose -- closes a hash table */
 void lhclose(lhashtable_t *lhtp);
 
-/* lhput -- puts an entry into a hash table under designated key 
+/* lhput -- puts an entry into a hash table under designated key
  * returns 0 for success; non-zero otherwise
  */
 int32_t lhput(lhashtable_t *lhtp, void *ep, const char *key, int keylen);
@@ -27,16 +31,53 @@ void lhapply(lhashtable_t *lhtp, void (*fn)(void* ep));
  * designated search fn -- returns a pointer to the entry or NULL if
  * not found
  */
-void *lhsearch(lhashtable_t *lhtp, 
-	      bool (*searchfn)(void* elementp, const void* searchkeyp), 
-	      const char *key, 
+void *lhsearch(lhashtable_t *lhtp,
+	      bool (*searchfn)(void* elementp, const void* searchkeyp),
+	      const char *key,
 	      int32_t keylen);
 
 /* lhremove -- removes and returns an entry under a designated key
  * using a designated search fn -- returns a pointer to the entry or
  * NULL if not found
  */
-void *lhremove(lhashtable_t *lhtp, 
-	      bool (*searchfn)(void* elementp, const void* searchkeyp), 
-	      const char *key, 
+void *lhremove(lhashtable_t *lhtp,
+	      bool (*searchfn)(void* elementp, const void* searchkeyp),
+	      const char *key,
 	      int32_t keylen);
+
+/* lhputh -- puts an entry into a hash table under a hash of its key that
+ * the caller has computed; entries put this way must be searched for
+ * with lhsearchh and the same hash
+ * returns 0 for success; non-zero otherwise
+ */
+int32_t lhputh(lhashtable_t *lhtp, void *ep, uint32_t hash);
+
+/* lhsearchh -- searches for an entry put with lhputh under hash, using a
+ * designated search fn -- returns a pointer to the entry or NULL if not
+ * found
+ */
+void *lhsearchh(lhashtable_t *lhtp,
+		bool (*searchfn)(void* elementp, const void* searchkeyp),
+		const void *key,
+		uint32_t hash);
+
+/* lhsearchputh -- searches for an entry under hash as lhsearchh does and,
+ * if there is none, puts the entry makefn returns for the key under hash;
+ * no other thread can put an entry for the key in between, so threads
+ * putting the same key all get the one entry -- returns the entry found
+ * or put, or NULL if makefn returns NULL or the entry cannot be put
+ */
+void *lhsearchputh(lhashtable_t *lhtp,
+		   bool (*searchfn)(void* elementp, const void* searchkeyp),
+		   const void *key,
+		   uint32_t hash,
+		   void *(*makefn)(const void *key));
+
+/* lhremoveh -- removes and returns an entry put with lhputh under hash,
+ * found as by lhsearchh -- returns a pointer to the entry or NULL if not
+ * found
+ */
+void *lhremoveh(lhashtable_t *lhtp,
+		bool (*searchfn)(void* elementp, const void* searchkeyp),
+		const void *key,
+		uint32_t hash);
@@ -0,0 +1,181 @@
+/*
+ * lhashtest.c --- checks that threads racing on the same keys of a locked hash table agree
+ *
+ * Author: Joshua M. Meise
+ * Created: 11-19-2023
+ * Version: 1.0
+ *
+ * Description: Every thread puts every key with lhsearchputh, each starting at a different key, so
+ *              that threads keep missing the same key at the same time. Exactly one entry must be
+ *              made per key, and every thread must be handed that entry. The threads then remove
+ *              the keys again, each its own share, while searching for the others. Built with
+ *              ThreadSanitizer and run by "make lhashtest"; exits non-zero on any failure.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <hash.h>
+#include <lhash.h>
+
+// Threads racing, and keys each of them puts.
+#define NTHREADS 8
+#define NKEYS 20000
+
+/* This structure contains an entry of the table: its key. */
+typedef struct entry {
+	int32_t key;
+} entry_t;
+
+// The table raced on; entries made so far; the entry each thread was handed for each key.
+static lhashtable_t *table;
+static atomic_int made;
+static entry_t *got[NTHREADS][NKEYS];
+
+/*
+ * Hash of a key, as the table files it.
+ */
+static uint32_t hashOf(int32_t key) {
+	return hhash((const char *)&key, sizeof(key));
+}
+
+/*
+ * Compares the key of an entry to the key being searched for.
+ */
+static bool searchKey(void *elementp, const void *searchkeyp) {
+	return ((entry_t *)elementp)->key == *(const int32_t *)searchkeyp;
+}
+
+/*
+ * Makes the entry for a key that is not in the table, counting it.
+ */
+static void *makeEntry(const void *key) {
+	// Variable declarations.
+	entry_t *ep;
+
+	if ((ep = (entry_t *)malloc(sizeof(entry_t))) == NULL)
+		return NULL;
+
+	ep->key = *(const int32_t *)key;
+	atomic_fetch_add(&made, 1);
+	return ep;
+}
+
+/*
+ * Puts every key, starting at the thread's own share of them.
+ * Inputs: pointer to the thread's number.
+ */
+static void *putKeys(void *argp) {
+	// Variable declarations.
+	int32_t t = *(int32_t *)argp, i, key;
+
+	for (i = 0; i < NKEYS; i++) {
+		key = (i + t*(NKEYS/NTHREADS))%NKEYS;
+		got[t][key] = (entry_t *)lhsearchputh(table, searchKey, &key, hashOf(key), makeEntry);
+	}
+
+	return NULL;
+}
+
+/*
+ * Removes the thread's share of the keys, searching for a key of the next share after each.
+ * Inputs: pointer to the thread's number.
+ */
+static void *removeKeys(void *argp) {
+	// Variable declarations.
+	int32_t t = *(int32_t *)argp, key, other;
+	entry_t *ep;
+
+	for (key = t; key < NKEYS; key += NTHREADS) {
+		if ((ep = (entry_t *)lhremoveh(table, searchKey, &key, hashOf(key))) == NULL || ep->key != key)
+			got[t][key] = NULL;
+		free(ep);
+
+		other = (key + 1)%NKEYS;
+		lhsearchh(table, searchKey, &other, hashOf(other));
+	}
+
+	return NULL;
+}
+
+/*
+ * Runs a function on every thread and waits for them all.
+ * Outputs: 0 for success; non-zero otherwise.
+ */
+static int32_t race(void *(*fn)(void *)) {
+	// Variable declarations.
+	pthread_t threads[NTHREADS];
+	int32_t nums[NTHREADS], i;
+
+	for (i = 0; i < NTHREADS; i++) {
+		nums[i] = i;
+		if (pthread_create(&threads[i], NULL, fn, &nums[i]) != 0)
+			return 1;
+	}
+
+	for (i = 0; i < NTHREADS; i++)
+		if (pthread_join(threads[i], NULL) != 0)
+			return 1;
+
+	return 0;
+}
+
+int main(void) {
+	// Variable declarations.
+	int32_t t, key, failures = 0;
+
+	// A small table, so that the stripes grow while the threads race.
+	if ((table = lhopen(16)) == NULL)
+		exit(EXIT_FAILURE);
+	atomic_init(&made, 0);
+
+	if (race(putKeys) != 0)
+		exit(EXIT_FAILURE);
+
+	// One entry per key, the one every thread was handed and the one the table holds.
+	if (atomic_load(&made) != NKEYS) {
+		printf("lhashtest: %d entries made for %d keys\n", atomic_load(&made), NKEYS);
+		failures++;
+	}
+
+	for (key = 0; key < NKEYS; key++) {
+		for (t = 0; t < NTHREADS; t++) {
+			if (got[t][key] == NULL || got[t][key] != got[0][key] || got[t][key]->key != key) {
+				printf("lhashtest: thread %d was handed the wrong entry for key %d\n", t, key);
+				failures++;
+				break;
+			}
+		}
+		if (lhsearchh(table, searchKey, &key, hashOf(key)) != got[0][key]) {
+			printf("lhashtest: the table does not hold the entry for key %d\n", key);
+			failures++;
+		}
+	}
+
+	// Every key is removed once, by its own thread, and then none is left.
+	if (race(removeKeys) != 0)
+		exit(EXIT_FAILURE);
+
+	for (key = 0; key < NKEYS; key++) {
+		if (got[key%NTHREADS][key] == NULL) {
+			printf("lhashtest: key %d was not removed\n", key);
+			failures++;
+		}
+		if (lhsearchh(table, searchKey, &key, hashOf(key)) != NULL) {
+			printf("lhashtest: key %d is still in the table\n", key);
+			failures++;
+		}
+	}
+
+	lhclose(table);
+
+	if (failures != 0)
+		exit(EXIT_FAILURE);
+
+	printf("lhashtest: %d threads agreed on %d keys\n", NTHREADS, NKEYS);
+	exit(EXIT_SUCCESS);
+}
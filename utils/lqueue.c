@@ -9,10 +9,17 @@
 /*
  * This structure contains the hidden aspcents of a locked queue.
  * Each locked queue contains a queue and an associated mutex.
+ * The blocking functions also use the count of elements, the most the queue
+ * may hold (0 for no limit), whether lqdone has been called and two conditions.
  */
 typedef struct privatelqueue {
 	queue_t *qp;
 	pthread_mutex_t m;
+	pthread_cond_t notEmpty;
+	pthread_cond_t notFull;
+	uint32_t count;
+	uint32_t cap;
+	bool done;
 } privatelqueue_t;
 
 /* 
@@ -21,6 +28,15 @@ typedef struct privatelqueue {
  * outputs: pointer to the new queue that was created
  */
 lqueue_t* lqopen(void) {
+	return lqopenbounded(0);
+}
+
+/*
+ * create an empty locked queue holding at most cap elements for the blocking functions
+ * inputs: most elements the queue may hold, 0 for no limit
+ * outputs: pointer to the new queue that was created
+ */
+lqueue_t* lqopenbounded(uint32_t cap) {
 	// Variable declarations.
 	privatelqueue_t *plqp;
 
@@ -28,10 +44,15 @@ lqueue_t* lqopen(void) {
 	if((plqp = (privatelqueue_t *)malloc(sizeof(privatelqueue_t))) == NULL)
 		return NULL;
 
-	// Initialise the new locked queue's aspects; queue and mutex.
-	if ((plqp->qp = qopen()) == NULL || pthread_mutex_init(&(plqp->m), NULL) != 0)
+	// Initialise the new locked queue's aspects; queue, mutex and conditions.
+	if ((plqp->qp = qopen()) == NULL || pthread_mutex_init(&(plqp->m), NULL) != 0 ||
+			pthread_cond_init(&(plqp->notEmpty), NULL) != 0 || pthread_cond_init(&(plqp->notFull), NULL) != 0)
 		return NULL;
 
+	plqp->count = 0;
+	plqp->cap = cap;
+	plqp->done = false;
+
 	return (lqueue_t *)plqp;
 
 }
@@ -44,8 +65,10 @@ void lqclose(lqueue_t *lqp) {
 	// Close the associated queue.
 	qclose(plqp->qp);
 
-	// Destroy the mutex.
+	// Destroy the mutex and conditions.
 	pthread_mutex_destroy(&(plqp->m));
+	pthread_cond_destroy(&(plqp->notEmpty));
+	pthread_cond_destroy(&(plqp->notFull));
 
 	// Free the locked queue data structure.
 	free(plqp);
@@ -69,8 +92,12 @@ int32_t lqput(lqueue_t *lqp, void *elementp) {
 		return 1;
 
 	// Put element into associated queue.
-	if (qput(plqp->qp, elementp) != 0)
+	if (qput(plqp->qp, elementp) != 0) {
+		pthread_mutex_unlock(&(plqp->m));
 		return 1;
+	}
+	plqp->count++;
+	pthread_cond_signal(&(plqp->notEmpty));
 
 	// Unlock mutex.
 	if (pthread_mutex_unlock(&(plqp->m)) != 0)
@@ -80,6 +107,43 @@ int32_t lqput(lqueue_t *lqp, void *elementp) {
 	
 }
 
+/* 
+ * put element at the end of the queue, waiting while the queue is full
+ * inputs: pointer to queue into which to insert, popinter to element to be inserted
+ * returns 0 is successful; nonzero otherwise or once lqdone has been called
+ */
+int32_t lqputwait(lqueue_t *lqp, void *elementp) {
+	// Variable declarations and coercing.
+	privatelqueue_t *plqp = (privatelqueue_t *)lqp;
+	int32_t res = 1;
+
+	// Check that queue and element exist.
+	if(plqp == NULL || elementp == NULL)
+		return 1;
+
+	// Lock the mutex associated with the locked queue.
+	if (pthread_mutex_lock(&(plqp->m)) != 0)
+		return 1;
+
+	// Wait for room.
+	while (plqp->cap > 0 && plqp->count >= plqp->cap && !plqp->done)
+		pthread_cond_wait(&(plqp->notFull), &(plqp->m));
+
+	// Put element into associated queue and wake a waiting getter.
+	if (!plqp->done && qput(plqp->qp, elementp) == 0) {
+		plqp->count++;
+		pthread_cond_signal(&(plqp->notEmpty));
+		res = 0;
+	}
+
+	// Unlock mutex.
+	if (pthread_mutex_unlock(&(plqp->m)) != 0)
+		return 1;
+
+	return res;
+
+}
+
 /*
  * get the first first element from queue, removing it from the queue 
  * inputs: queue from which first element is being taken
@@ -99,7 +163,10 @@ void* lqget(lqueue_t *lqp) {
 		return NULL;
 
 	// Get first element from associated queue.
-	data = qget(plqp->qp);
+	if ((data = qget(plqp->qp)) != NULL) {
+		plqp->count--;
+		pthread_cond_signal(&(plqp->notFull));
+	}
 	
 	// Unlock mutex.
 	if (pthread_mutex_unlock(&(plqp->m)) != 0)
@@ -109,6 +176,59 @@ void* lqget(lqueue_t *lqp) {
 
 }
 
+/*
+ * get the first element from queue, waiting while the queue is empty
+ * inputs: queue from which first element is being taken
+ * outputs: pointer to the data on that node of the queue, NULL once lqdone has been called and the queue is empty
+ */
+void* lqgetwait(lqueue_t *lqp) {
+	// Variable declarations and coercing.
+	void *data;
+	privatelqueue_t *plqp = (privatelqueue_t *)lqp;
+
+	// Check that queue exists.
+	if(plqp == NULL)
+		return NULL;
+
+	// Lock the mutex associated with the locked queue.
+	if (pthread_mutex_lock(&(plqp->m)) != 0)
+		return NULL;
+
+	// Wait for an element or for the end.
+	while (plqp->count == 0 && !plqp->done)
+		pthread_cond_wait(&(plqp->notEmpty), &(plqp->m));
+
+	// Get first element from associated queue and wake a waiting putter.
+	if ((data = qget(plqp->qp)) != NULL) {
+		plqp->count--;
+		pthread_cond_signal(&(plqp->notFull));
+	}
+
+	// Unlock mutex.
+	if (pthread_mutex_unlock(&(plqp->m)) != 0)
+		return NULL;
+
+	return data;
+
+}
+
+/*
+ * tell everyone waiting on the queue that nothing more will be put in it
+ * inputs: the queue
+ * outputs: none
+ */
+void lqdone(lqueue_t *lqp) {
+	// Variable declarations and coercing.
+	privatelqueue_t *plqp = (privatelqueue_t *)lqp;
+
+	pthread_mutex_lock(&(plqp->m));
+	plqp->done = true;
+	pthread_cond_broadcast(&(plqp->notEmpty));
+	pthread_cond_broadcast(&(plqp->notFull));
+	pthread_mutex_unlock(&(plqp->m));
+
+}
+
 /* 
  * apply a function to every element of the queue 
  * inputs: the queue to which the function will be applied, the function to apply which takes the data from a queue's node as an input
@@ -14,6 +14,11 @@ typedef void lqueue_t;
 /* create an empty lcoked queue */
 lqueue_t* lqopen(void);        
 
+/* create an empty locked queue that holds at most cap elements for the
+ * blocking functions below; cap 0 means no limit
+ */
+lqueue_t* lqopenbounded(uint32_t cap);
+
 /* deallocate a locked queue, frees everything in it */
 void lqclose(lqueue_t *lqp);   
 
@@ -40,3 +45,16 @@ void lqapply(lqueue_t *lqp, void (*fn)(void* elementp));
 void* lqsearch(lqueue_t *lqp, 
 							bool (*searchfn)(void* elementp,const void* keyp),
 							const void* skeyp);
+
+/* put element at the end of the locked queue, waiting while it is full
+ * returns 0 if successful; nonzero otherwise, or once lqdone has been called
+ */
+int32_t lqputwait(lqueue_t *lqp, void *elementp);
+
+/* get the first element from the locked queue, waiting while it is empty
+ * returns NULL once lqdone has been called and the queue is empty
+ */
+void* lqgetwait(lqueue_t *lqp);
+
+/* tell everyone waiting on the locked queue that nothing more will be put in it */
+void lqdone(lqueue_t *lqp);
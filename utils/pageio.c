@@ -9,20 +9,254 @@
  * 
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <pageio.h>
+#include <urlset.h>
 #include <sys/stat.h>
 #include <stdio.h>
+#include <limits.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+
+// Names of the segment file holding the pages of a directory and of its table.
+#define SEGMENT "pages.seg"
+#define TABLE "pages.idx"
+#define METATABLE "pages.meta"
+
+// Most directories whose page store a program may use.
+#define MAXSTORES 8
+
+// Size of the chunks a streamed page is copied into the segment in.
+#define COPYSIZE 65536
+
+/*
+ * This structure contains an open page store: the segment every page is appended to, the table of
+ * where each page is in it, the table of each page's metadata, and where the next page will go.
+ */
+typedef struct store {
+	char dir[PATH_MAX];
+	int seg;
+	int idx;
+	int meta;
+	off_t end;
+} store_t;
+
+// Page stores opened so far; they stay open until the program exits.
+static store_t stores[MAXSTORES];
+static int32_t numStores = 0;
+static pthread_mutex_t storeLock = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * Finds the open store of a directory, opening it if its files exist or, for a writer, creating them.
+ * Inputs: directory, whether to create the store.
+ * Outputs: the store, NULL if there is none.
+ */
+static store_t *getStore(char *dirnm, bool create) {
+	// Variable declarations.
+	store_t *sp = NULL;
+	char name[PATH_MAX];
+	int32_t i, flags = create ? O_RDWR | O_CREAT : O_RDWR;
+	struct stat st;
+
+	pthread_mutex_lock(&storeLock);
+
+	for (i = 0; i < numStores && sp == NULL; i++)
+		if (strcmp(stores[i].dir, dirnm) == 0)
+			sp = &stores[i];
+
+	if (sp == NULL && numStores < MAXSTORES && strlen(dirnm) < PATH_MAX) {
+		sp = &stores[numStores];
+		snprintf(name, sizeof(name), "%s/%s", dirnm, SEGMENT);
+		if ((sp->seg = open(name, flags, 0666)) == -1 && create == false)
+			sp->seg = open(name, O_RDONLY);
+
+		snprintf(name, sizeof(name), "%s/%s", dirnm, TABLE);
+		if ((sp->idx = open(name, flags, 0666)) == -1 && create == false)
+			sp->idx = open(name, O_RDONLY);
+
+		// A directory without both files keeps its pages one per file.
+		if (sp->seg == -1 || sp->idx == -1 || fstat(sp->seg, &st) != 0) {
+			if (sp->seg != -1)
+				close(sp->seg);
+			if (sp->idx != -1)
+				close(sp->idx);
+			sp = NULL;
+		}
+		else {
+			// Stores written before metadata was kept in them get its table once they can be written.
+			snprintf(name, sizeof(name), "%s/%s", dirnm, METATABLE);
+			if ((sp->meta = open(name, O_RDWR | O_CREAT, 0666)) == -1)
+				sp->meta = open(name, O_RDONLY);
+
+			strcpy(sp->dir, dirnm);
+			sp->end = st.st_size;
+			numStores++;
+		}
+	}
+
+	pthread_mutex_unlock(&storeLock);
+	return sp;
+}
+
+/*
+ * Writes all of a buffer at an offset of a file.
+ * Outputs: 0 for success, non-zero otherwise.
+ */
+static int32_t writeAt(int fd, const char *buf, size_t len, off_t off) {
+	// Variable declarations.
+	ssize_t n;
+
+	while (len > 0) {
+		if ((n = pwrite(fd, buf, len, off)) <= 0)
+			return 1;
+		buf += n;
+		len -= n;
+		off += n;
+	}
+
+	return 0;
+}
+
+/*
+ * Reads all of a buffer from an offset of a file.
+ * Outputs: 0 for success, non-zero otherwise.
+ */
+static int32_t readAt(int fd, char *buf, size_t len, off_t off) {
+	// Variable declarations.
+	ssize_t n;
+
+	while (len > 0) {
+		if ((n = pread(fd, buf, len, off)) <= 0)
+			return 1;
+		buf += n;
+		len -= n;
+		off += n;
+	}
+
+	return 0;
+}
+
+/*
+ * Sets aside room for a page at the end of a store's segment.
+ * Outputs: offset of the room.
+ */
+static off_t reserve(store_t *sp, size_t len) {
+	// Variable declarations.
+	off_t off;
+
+	pthread_mutex_lock(&storeLock);
+	off = sp->end;
+	sp->end += len;
+	pthread_mutex_unlock(&storeLock);
+
+	return off;
+}
+
+/*
+ * Points the table entry of page <id> at the page's place in the segment.
+ * Outputs: 0 for success, non-zero otherwise.
+ */
+static int32_t setEntry(store_t *sp, int id, off_t off, size_t len) {
+	// Variable declarations.
+	uint64_t entry[2];
+
+	entry[0] = off;
+	entry[1] = len;
+	return writeAt(sp->idx, (char *)entry, sizeof(entry), (off_t)(id - 1)*sizeof(entry));
+}
+
+/*
+ * Looks up where page <id> is in the segment of a directory.
+ * Inputs: file ID, directory, where to put the store, offset and length of the page.
+ * Outputs: 0 if the page is in the segment, non-zero otherwise.
+ */
+static int32_t getEntry(int id, char *dirnm, store_t **spp, off_t *off, size_t *len) {
+	// Variable declarations.
+	uint64_t entry[2];
+
+	if (id <= 0 || (*spp = getStore(dirnm, false)) == NULL)
+		return 1;
+
+	// Entries past the end of the table, or never written, are empty.
+	if (readAt((*spp)->idx, (char *)entry, sizeof(entry), (off_t)(id - 1)*sizeof(entry)) != 0 || entry[1] == 0)
+		return 1;
+
+	*off = entry[0];
+	*len = entry[1];
+	return 0;
+}
+
+/*
+ * Reads a page in the saved format from an open file.
+ * Inputs: file positioned at the start of the page.
+ * Outputs: the page, NULL on failure.
+ */
+static webpage_t *readPage(FILE *ifile) {
+	// Variable declarations.
+	webpage_t *newPage;
+	char *URL = NULL, *html;
+	size_t URLSize = 0;
+	ssize_t URLLen;
+	int32_t depth, htmlLen, i;
+
+	// Read the URL from the file by reading the whole first line, however long, newline included.
+	if ((URLLen = getline(&URL, &URLSize, ifile)) <= 1 || URL[URLLen - 1] != '\n') {
+		free(URL);
+		return NULL;
+	}
+	URL[URLLen - 1] = '\0';
+
+	// Read in an integer for the depth.
+	if (fscanf(ifile, "%d", &depth) != 1) {
+		free(URL);
+		return NULL;
+	}
+
+	// Read in the newline character.
+	fgetc(ifile);
+
+	// Read in html length.
+	if (fscanf(ifile, "%d", &htmlLen) != 1 || htmlLen < 0) {
+		free(URL);
+		return NULL;
+	}
+
+	// Read in the newline character.
+	fgetc(ifile);
+
+	// Allocate memory for html string.
+	if ((html = (char *)malloc(htmlLen*sizeof(char) + sizeof(char))) == NULL) {
+		free(URL);
+		return NULL;
+	}
+
+	// Read the html and make last character null terminator.
+	i = fread(html, sizeof(char), htmlLen, ifile);
+	html[i] = '\0';
+
+	// Create a webpage at the URL read.
+	if ((newPage = webpage_new(URL, depth, html)) == NULL)
+		free(html);
+	free(URL);
+
+	// Return the new page.
+	return newPage;
+}
 
 /*
- * This function saed the details of a webpage to a file.
+ * This function saed the details of a webpage to the directory's page store.
  * Inputs: Webpage to save, file ID, directory to save.
  * Output: Zero for success, non-zero otherwise.
  */
 int32_t pagesave(webpage_t *pagep, int id, char *dirname) {
 	// Variable declarations.
-	char name[50];
-	FILE *ifile;
+	char *header;
+	store_t *sp;
 	struct stat dir;
+	size_t headLen, htmlLen;
+	off_t off;
 
 	// Get details of directory.
 	stat(dirname, &dir);
@@ -32,33 +266,30 @@ int32_t pagesave(webpage_t *pagep, int id, char *dirname) {
 		if (mkdir(dirname, 0777) == -1)
 			return 1;
 
-	// Create the file name in the specified directory.
-	sprintf(name, "%s/%d", dirname, id);
-
-	// Open the file for writing.
-	ifile = fopen(name, "w");
+	if (id <= 0 || (sp = getStore(dirname, true)) == NULL)
+		return 1;
 
-	// Return 1 if file not opened for writing properly.
-	if (access(name, W_OK) != 0)
+	// The url, depth and html length go before the html, in a buffer as long as they need.
+	htmlLen = webpage_getHTMLlen(pagep);
+	headLen = snprintf(NULL, 0, "%s\n%d\n%d\n", webpage_getURL(pagep), webpage_getDepth(pagep), (int)htmlLen);
+	if ((header = (char *)malloc(headLen + 1)) == NULL)
 		return 1;
+	snprintf(header, headLen + 1, "%s\n%d\n%d\n", webpage_getURL(pagep), webpage_getDepth(pagep), (int)htmlLen);
 
-	// Print relevant detatils to file.
-	fprintf(ifile, "%s\n", webpage_getURL(pagep));
-	fprintf(ifile, "%d\n", webpage_getDepth(pagep));
-	fprintf(ifile, "%d\n", webpage_getHTMLlen(pagep));
-	fprintf(ifile, "%s", webpage_getHTML(pagep));
+	// Append the page to the segment, then point its entry at it.
+	off = reserve(sp, headLen + htmlLen);
+	if (writeAt(sp->seg, header, headLen, off) != 0 || writeAt(sp->seg, webpage_getHTML(pagep), htmlLen, off + headLen) != 0) {
+		free(header);
+		return 1;
+	}
+	free(header);
 
-	// Close file.
-	fclose(ifile);
+	return setEntry(sp, id, off, headLen + htmlLen);
 
-	// Return 0 for success.
-	return (0);
-	
 }
 
 /* 
- * pageload -- loads the numbered filename <id> in direcory <dirnm>
- * into a new webpage
+ * pageload -- loads page <id> in direcory <dirnm> into a new webpage
  * inputs: id of file to load and directory in which file lives
  * returns: non-NULL for success; NULL otherwise
  */
@@ -66,66 +297,420 @@ webpage_t *pageload(int id, char *dirnm) {
 	// Variable declarations.
 	webpage_t *newPage;
 	FILE *ifile;
-	struct stat dir;
-	char name[50], URL[500], *html, ch;
-	int32_t depth, htmlLen, i;
-	
-	// Get details of directory.
-	stat(dirnm, &dir);
+	store_t *sp;
+	char name[PATH_MAX], *buf;
+	off_t off;
+	size_t len;
 
-	// Check if directory exists; if not return NULL
-	if (S_ISDIR(dir.st_mode) == 0)
-		return NULL;
+	// Pages in the segment are read with one call and parsed in memory.
+	if (getEntry(id, dirnm, &sp, &off, &len) == 0) {
+		if ((buf = (char *)malloc(len)) == NULL)
+			return NULL;
 
-	// Create the file name in the specified directory.
-	sprintf(name, "%s/%d", dirnm, id);
+		newPage = NULL;
+		if (readAt(sp->seg, buf, len, off) == 0 && (ifile = fmemopen(buf, len, "r")) != NULL) {
+			newPage = readPage(ifile);
+			fclose(ifile);
+		}
 
-	// Open the file for reading.
-	ifile = fopen(name, "r");
+		free(buf);
+		return newPage;
+	}
 
-	// Return NULL if file not opened for reading properly.
-	if (access(name, R_OK) != 0)
+	// Otherwise the page may have a file of its own.
+	snprintf(name, sizeof(name), "%s/%d", dirnm, id);
+	if ((ifile = fopen(name, "r")) == NULL)
 		return NULL;
 
-	// Read the URL from the file by reading to the end of the first line.
-	fscanf(ifile, "%[^\n]", URL);
+	newPage = readPage(ifile);
+	fclose(ifile);
 
-	// Read in the newline character.
-	fgetc(ifile);
+	// Return the new page.
+	return newPage;
+}
 
-	// Read in an integer for the depth.
-	fscanf(ifile, "%d", &depth);
+/*
+ * returns true if page <id> has been saved in a directory
+ */
+bool pageexists(int id, char *dirnm) {
+	// Variable declarations.
+	store_t *sp;
+	off_t off;
+	size_t len;
+	char name[PATH_MAX];
 
-	// Read in the newline character.
-	fgetc(ifile);
-	
-	// Read in html length.
-	fscanf(ifile, "%d", &htmlLen);
+	if (getEntry(id, dirnm, &sp, &off, &len) == 0)
+		return true;
 
-	// Read in the newline character.
-	fgetc(ifile);	
+	snprintf(name, sizeof(name), "%s/%d", dirnm, id);
+	return access(name, R_OK) == 0;
+}
 
-	// Allocate memory for html string.
-	html = (char *)malloc(htmlLen*sizeof(char) + sizeof(char));
+/*
+ * Finds the pages of a directory and their sizes, reading the whole table of its page store at once.
+ * Inputs: directory, where to put the array of sizes.
+ * Outputs: the number of pages, -1 if memory runs out.
+ */
+int32_t pagesizes(char *dirnm, size_t **sizes) {
+	// Variable declarations.
+	store_t *sp;
+	uint64_t *table = NULL;
+	size_t *grown, numEntries = 0, size = 0;
+	int32_t n = 0;
+	char name[PATH_MAX];
+	struct stat st;
 
-	// Start inserting into html at position 0.
-	i = 0;
-	
-	// Read the file character by character and place them into html.
-	while ((ch = fgetc(ifile)) != EOF) {
-		html[i] = ch;
-		i++;
+	*sizes = NULL;
+
+	// One read of the table gives every page in the segment.
+	if ((sp = getStore(dirnm, false)) != NULL && fstat(sp->idx, &st) == 0 && st.st_size >= 2*sizeof(uint64_t)) {
+		numEntries = st.st_size/(2*sizeof(uint64_t));
+		if ((table = (uint64_t *)malloc(numEntries*2*sizeof(uint64_t))) == NULL)
+			return -1;
+		if (readAt(sp->idx, (char *)table, numEntries*2*sizeof(uint64_t), 0) != 0)
+			numEntries = 0;
 	}
 
-	// Make last character null terminator.
-	html[i] = '\0';
+	for (;;) {
+		// Pages not in the segment may have a file of their own.
+		if (n < numEntries && table[2*n + 1] != 0)
+			st.st_size = table[2*n + 1];
+		else {
+			snprintf(name, sizeof(name), "%s/%d", dirnm, n + 1);
+			if (stat(name, &st) != 0)
+				break;
+		}
+
+		if (n == size) {
+			size = size == 0 ? 1024 : 2*size;
+			if ((grown = (size_t *)realloc(*sizes, size*sizeof(size_t))) == NULL) {
+				free(*sizes);
+				free(table);
+				*sizes = NULL;
+				return -1;
+			}
+			*sizes = grown;
+		}
+		(*sizes)[n++] = st.st_size;
+	}
+
+	free(table);
+	return n;
+}
+
+/*
+ * This function reads the URL of a saved page without its html.
+ * Inputs: file ID, directory, where to put the URL and its size.
+ * Outputs: Zero for success, non-zero otherwise.
+ */
+int32_t pageurl(int id, char *dirnm, char *url, size_t size) {
+	// Variable declarations.
+	store_t *sp;
+	off_t off;
+	size_t len;
+	char name[PATH_MAX];
+	FILE *ifile;
+
+	if (size == 0)
+		return 1;
+
+	// The URL is the first line of the page.
+	if (getEntry(id, dirnm, &sp, &off, &len) == 0) {
+		if (len > size - 1)
+			len = size - 1;
+		if (readAt(sp->seg, url, len, off) != 0)
+			return 1;
+		url[len] = '\0';
+	}
+	else {
+		snprintf(name, sizeof(name), "%s/%d", dirnm, id);
+		if ((ifile = fopen(name, "r")) == NULL)
+			return 1;
+		if (fgets(url, size, ifile) == NULL) {
+			fclose(ifile);
+			return 1;
+		}
+		fclose(ifile);
+	}
+
+	// A line that does not fit is no URL.
+	if (strchr(url, '\n') == NULL)
+		return 1;
+
+	url[strcspn(url, "\n")] = '\0';
+	return 0;
+}
+
+/*
+ * This function empties the page store of a directory.
+ * Inputs: directory.
+ * Outputs: Zero for success, non-zero otherwise.
+ */
+int32_t pageclear(char *dirnm) {
+	// Variable declarations.
+	store_t *sp;
+	int32_t res = 0, id, found;
+	char name[PATH_MAX];
+
+	// Files of pages saved before the store existed, and of their metadata, go too; the store falls back to them.
+	for (id = 1, found = 1; found > 0; id++) {
+		found = 0;
+		snprintf(name, sizeof(name), "%s/%d", dirnm, id);
+		if (remove(name) == 0)
+			found++;
+		else if (errno != ENOENT)
+			return 1;
+
+		snprintf(name, sizeof(name), "%s/%d.meta", dirnm, id);
+		if (remove(name) == 0)
+			found++;
+		else if (errno != ENOENT)
+			return 1;
+	}
+
+	if ((sp = getStore(dirnm, false)) == NULL)
+		return 0;
+
+	pthread_mutex_lock(&storeLock);
+	if (ftruncate(sp->seg, 0) != 0 || ftruncate(sp->idx, 0) != 0 || (sp->meta != -1 && ftruncate(sp->meta, 0) != 0))
+		res = 1;
+	sp->end = 0;
+	pthread_mutex_unlock(&storeLock);
+
+	return res;
+}
+
+/*
+ * Copies a validator into a metadata field, truncating it if it is too long.
+ */
+static void copyValidator(char *field, const char *value) {
+	field[0] = '\0';
+	if (value != NULL)
+		strncat(field, value, MAXVALIDATOR - 1);
+}
+
+/*
+ * This function saves the metadata of a saved page in its directory's page store.
+ * Inputs: metadata, file ID, directory of the page.
+ * Output: Zero for success, non-zero otherwise.
+ */
+int32_t pagemetasave(pagemeta_t *meta, int id, char *dirnm) {
+	// Variable declarations.
+	store_t *sp;
+	uint64_t entry[3];
+	char *validators;
+	int len;
+
+	if (id <= 0 || (sp = getStore(dirnm, true)) == NULL || sp->meta == -1)
+		return 1;
+
+	entry[0] = meta->hash;
+	entry[1] = 0;
+	entry[2] = 0;
+
+	// Validators are appended to the segment, and only if the server sent any.
+	if (meta->etag[0] != '\0' || meta->lastmod[0] != '\0') {
+		len = snprintf(NULL, 0, "%s\n%s\n", meta->etag, meta->lastmod);
+		if ((validators = (char *)malloc(len + 1)) == NULL)
+			return 1;
+		snprintf(validators, len + 1, "%s\n%s\n", meta->etag, meta->lastmod);
+
+		entry[1] = reserve(sp, len);
+		entry[2] = len;
+		if (writeAt(sp->seg, validators, len, entry[1]) != 0) {
+			free(validators);
+			return 1;
+		}
+		free(validators);
+	}
+
+	return writeAt(sp->meta, (char *)entry, sizeof(entry), (off_t)(id - 1)*sizeof(entry));
+}
+
+/*
+ * Reads the metadata of a page saved before metadata was kept in the page store, from <id>.meta.
+ * Inputs: where to put the metadata, file ID, directory of the page.
+ * Output: Zero for success, non-zero otherwise.
+ */
+static int32_t loadMetaFile(pagemeta_t *meta, int id, char *dirnm) {
+	// Variable declarations.
+	char name[PATH_MAX], line[MAXVALIDATOR + 2];
+	FILE *ifile;
+	int32_t result = 1;
+
+	snprintf(name, sizeof(name), "%s/%d.meta", dirnm, id);
+
+	if ((ifile = fopen(name, "r")) == NULL)
+		return 1;
+
+	// Read the two validators, then the hash.
+	if (fgets(line, sizeof(line), ifile) != NULL) {
+		line[strcspn(line, "\n")] = '\0';
+		copyValidator(meta->etag, line);
+
+		if (fgets(line, sizeof(line), ifile) != NULL) {
+			line[strcspn(line, "\n")] = '\0';
+			copyValidator(meta->lastmod, line);
+
+			if (fscanf(ifile, "%" SCNx64, &meta->hash) == 1)
+				result = 0;
+		}
+	}
 
-	// Close the file.
 	fclose(ifile);
+	return result;
+}
 
-	// Create a webpage at the URL read.
-	newPage = webpage_new(URL, depth, html);
+/*
+ * This function loads the metadata of a saved page.
+ * Inputs: where to put the metadata, file ID, directory of the page.
+ * Output: Zero for success, non-zero otherwise.
+ */
+int32_t pagemetaload(pagemeta_t *meta, int id, char *dirnm) {
+	// Variable declarations.
+	store_t *sp;
+	uint64_t entry[3];
+	char *validators, *lastmod;
 
-	// Return the new page.
-	return newPage;
+	// Entries past the end of the table, or never written, hold nothing.
+	if (id <= 0 || (sp = getStore(dirnm, false)) == NULL || sp->meta == -1 ||
+			readAt(sp->meta, (char *)entry, sizeof(entry), (off_t)(id - 1)*sizeof(entry)) != 0 ||
+			(entry[0] == 0 && entry[2] == 0))
+		return loadMetaFile(meta, id, dirnm);
+
+	meta->hash = entry[0];
+	meta->etag[0] = '\0';
+	meta->lastmod[0] = '\0';
+	if (entry[2] == 0)
+		return 0;
+
+	// The validators are two lines in the segment.
+	if ((validators = (char *)malloc(entry[2] + 1)) == NULL)
+		return 1;
+	if (readAt(sp->seg, validators, entry[2], entry[1]) != 0) {
+		free(validators);
+		return 1;
+	}
+	validators[entry[2]] = '\0';
+	if ((lastmod = strchr(validators, '\n')) == NULL) {
+		free(validators);
+		return 1;
+	}
+	*lastmod++ = '\0';
+	lastmod[strcspn(lastmod, "\n")] = '\0';
+
+	copyValidator(meta->etag, validators);
+	copyValidator(meta->lastmod, lastmod);
+	free(validators);
+	return 0;
+}
+
+/*
+ * Builds the name of the file a page is streamed into until its docID is known.
+ */
+static void streamName(char *name, size_t size, webpage_t *pagep, char *dirnm) {
+	char *url = webpage_getURL(pagep);
+
+	snprintf(name, size, "%s/.%016" PRIx64 ".part", dirnm, urlfingerprint(url, strlen(url)));
+}
+
+/*
+ * This function starts a page file whose html is streamed in by the fetch.
+ * Inputs: page about to be fetched, directory to save it in.
+ * Outputs: Zero for success, non-zero otherwise.
+ */
+int32_t pagestreambegin(webpage_t *pagep, char *dirnm) {
+	// Variable declarations.
+	char name[PATH_MAX];
+	FILE *ifile;
+
+	streamName(name, sizeof(name), pagep, dirnm);
+	if ((ifile = fopen(name, "w+")) == NULL)
+		return 1;
+
+	// The length is not known yet, so leave room for any length.
+	fprintf(ifile, "%s\n%d\n%*d\n", webpage_getURL(pagep), webpage_getDepth(pagep), STREAMLEN, 0);
+
+	// Everything fetched from here on goes after the header.
+	webpage_setSink(pagep, ifile);
+	return 0;
+}
+
+/*
+ * Copies a finished streamed page file to the end of the directory's segment.
+ * Inputs: streamed file, file ID, directory.
+ * Outputs: Zero for success, non-zero otherwise.
+ */
+static int32_t appendStream(FILE *ifile, int id, char *dirnm) {
+	// Variable declarations.
+	store_t *sp;
+	struct stat st;
+	char *buf;
+	off_t off, at;
+	size_t n;
+	int32_t res = 0;
+
+	if (fflush(ifile) != 0 || fstat(fileno(ifile), &st) != 0 || (sp = getStore(dirnm, true)) == NULL)
+		return 1;
+
+	if ((buf = (char *)malloc(COPYSIZE)) == NULL)
+		return 1;
+
+	// Copy the file in large chunks.
+	off = reserve(sp, st.st_size);
+	for (at = 0; at < st.st_size && res == 0; at += n) {
+		n = st.st_size - at < COPYSIZE ? st.st_size - at : COPYSIZE;
+		if (readAt(fileno(ifile), buf, n, at) != 0 || writeAt(sp->seg, buf, n, off + at) != 0)
+			res = 1;
+	}
+
+	free(buf);
+	if (res != 0)
+		return 1;
+
+	return setEntry(sp, id, off, st.st_size);
+}
+
+/*
+ * This function finishes a streamed page file, or throws it away.
+ * Inputs: fetched page, file ID (0 to discard the file), directory.
+ * Outputs: Zero for success, non-zero otherwise.
+ */
+int32_t pagestreamend(webpage_t *pagep, int id, char *dirnm) {
+	// Variable declarations.
+	char tmpName[PATH_MAX];
+	FILE *ifile = webpage_getSink(pagep);
+	long lenAt;
+
+	if (ifile == NULL)
+		return 1;
+	webpage_setSink(pagep, NULL);
+	streamName(tmpName, sizeof(tmpName), pagep, dirnm);
+
+	// A failed fetch leaves nothing behind.
+	if (id <= 0) {
+		fclose(ifile);
+		remove(tmpName);
+		return 0;
+	}
+
+	// Cut off anything an earlier, longer attempt left past the end, then fill in the length.
+	lenAt = snprintf(NULL, 0, "%s\n%d\n", webpage_getURL(pagep), webpage_getDepth(pagep));
+	if (fflush(ifile) != 0 || ftruncate(fileno(ifile), ftell(ifile)) != 0 || fseek(ifile, lenAt, SEEK_SET) != 0 ||
+			fprintf(ifile, "%*d", STREAMLEN, webpage_getHTMLlen(pagep)) < 0) {
+		fclose(ifile);
+		return 1;
+	}
+
+	// Only now does the page appear under its number.
+	if (appendStream(ifile, id, dirnm) != 0) {
+		fclose(ifile);
+		return 1;
+	}
+
+	if (fclose(ifile) != 0)
+		return 1;
+
+	remove(tmpName);
+	return 0;
 }
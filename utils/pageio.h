@@ -6,24 +6,37 @@
  * Created: Fri Oct 19 08:30:15 2018 (-0400)
  * Version: 1.0
  * 
- * Description: pagesave saves an existing webpage to a file with a
- * numbered name (e.g. 1,2,3 etc); pageload creates a new page by
- * loading a numbered file. For pagesave, the directory must exist and
- * be writable; for loadpage it must be readable.
+ * Description: pagesave saves an existing webpage under a number
+ * (e.g. 1,2,3 etc); pageload creates a new page by loading a numbered
+ * page. For pagesave, the directory must exist and be writable; for
+ * loadpage it must be readable.
+ *
+ * The pages of a directory are kept in one page store: every page is
+ * appended to the segment file pages.seg, and entry <id> of the table
+ * pages.idx (two native 64-bit integers at offset (id-1)*16) holds the
+ * offset and length of page <id> in the segment, 0 length if there is
+ * none. Saving a page again appends it and moves its entry. Entry <id>
+ * of pages.meta (three native 64-bit integers at offset (id-1)*24) holds
+ * the page's metadata: its hash, then the offset and length in the
+ * segment of its validators, 0 length if there are none. Pages of
+ * directories written before the store existed, one file per page
+ * named <id> with its metadata in <id>.meta, are still read when the
+ * tables have no entry for them.
  */
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <inttypes.h>
 #include <unistd.h>
+#include <stdbool.h>
 #include <webpage.h>
 
 /*
- * pagesave -- save the page in filename id in directory dirnm
+ * pagesave -- save the page as page id in directory dirnm
  *
  * returns: 0 for success; nonzero otherwise
  *
- * The suggested format for the file is:
+ * The format of a page is:
  *   <url>
  *   <depth>
  *   <html-length>
@@ -32,9 +45,93 @@
 int32_t pagesave(webpage_t *pagep, int id, char *dirnm);
 
 /* 
- * pageload -- loads the numbered filename <id> in direcory <dirnm>
- * into a new webpage
+ * pageload -- loads page <id> in direcory <dirnm> into a new webpage
  *
  * returns: non-NULL for success; NULL otherwise
  */
 webpage_t *pageload(int id, char *dirnm);
+
+/* pageexists -- returns true if page <id> has been saved in directory dirnm */
+bool pageexists(int id, char *dirnm);
+
+/*
+ * pagesizes -- finds the pages saved in directory dirnm, numbered from 1 up
+ * to the first number with no page, all at once; *sizes is set to a new
+ * array, for the caller to free, whose element id-1 is the size in bytes of
+ * page <id> as saved
+ *
+ * returns: the number of pages; -1 if memory runs out
+ */
+int32_t pagesizes(char *dirnm, size_t **sizes);
+
+/*
+ * pageurl -- copy the url of page <id> in directory dirnm into url, which
+ * holds size characters, without loading its html
+ *
+ * returns: 0 for success; nonzero otherwise
+ */
+int32_t pageurl(int id, char *dirnm, char *url, size_t size);
+
+/*
+ * pageclear -- empty the page store of directory dirnm, and remove the
+ * files of pages saved without it and of page metadata, for a crawl that
+ * starts afresh
+ *
+ * returns: 0 for success; nonzero otherwise
+ */
+int32_t pageclear(char *dirnm);
+
+/* Longest ETag or Last-Modified value kept in a page's metadata. */
+#define MAXVALIDATOR 256
+
+/*
+ * Metadata kept with a saved page in its page store so that a later
+ * crawl can ask whether it changed and tell if its content did.
+ */
+typedef struct pagemeta {
+	char etag[MAXVALIDATOR];       // ETag of the response, empty if none
+	char lastmod[MAXVALIDATOR];    // Last-Modified of the response, empty if none
+	uint64_t hash;                 // fingerprint of the html (see urlfingerprint)
+} pagemeta_t;
+
+/*
+ * pagemetasave -- save the metadata of page <id> in the page store of
+ * directory dirnm; the validators, if there are any, are appended to the
+ * segment as
+ *   <etag>
+ *   <last-modified>
+ *
+ * returns: 0 for success; nonzero otherwise
+ */
+int32_t pagemetasave(pagemeta_t *meta, int id, char *dirnm);
+
+/*
+ * pagemetaload -- load the metadata of page <id> in directory dirnm into meta
+ *
+ * returns: 0 for success; nonzero if there is none
+ */
+int32_t pagemetaload(pagemeta_t *meta, int id, char *dirnm);
+
+/* Width of the html length written at the start of a streamed page. */
+#define STREAMLEN 10
+
+/*
+ * pagestreambegin -- start saving a page whose html is about to be fetched:
+ * the url and depth are written to a temporary file in dirnm, which becomes
+ * the page's sink (see webpage_setSink) so that the fetch writes its body
+ * straight to disk. The html length is written right-aligned in a fixed
+ * width, so the file holds a page in the usual format.
+ *
+ * returns: 0 for success; nonzero otherwise
+ */
+int32_t pagestreambegin(webpage_t *pagep, char *dirnm);
+
+/*
+ * pagestreamend -- finish a page started by pagestreambegin once its fetch is
+ * over: fill in the length and copy the file into the page store as page
+ * <id>, or, if id is 0 (the fetch failed), just remove it. Either way the
+ * page no longer has a sink.
+ *
+ * returns: 0 for success; nonzero otherwise
+ */
+int32_t pagestreamend(webpage_t *pagep, int id, char *dirnm);
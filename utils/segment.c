@@ -0,0 +1,628 @@
+/*
+ * segment.c --- implements the segment.h interface
+ *
+ * Author: Joshua M. Meise
+ * Created: 11-20-2023
+ * Version: 1.0
+ *
+ * Description: Which segment holds the current version of each document is worked out from the
+ *              segments' document lists, newest last, into an array indexed by docID. A merge picks
+ *              its segments and numbers the new one with the lock held, merges them with the lock
+ *              released, keeping from each only the documents it still holds the current version
+ *              of, and then, with the lock held again, puts the new segment in the manifest in the
+ *              place of the newest it was merged from and removes the others. Every document it
+ *              holds is newer there than in any segment before that place, and any segment added
+ *              since comes after it, so searches find the same postings before and after.
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <segment.h>
+#include <indexio.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#define MAXLINE 8192
+
+// First line of a manifest, naming the format and its version.
+#define MAGIC "TSE-SEGMENTS 1"
+
+// Segments of a tier merged at once; the sizes of the tiers go up by the same factor.
+#define MERGEFACTOR (4)
+
+// Most tiers a segment can be in, as its number of documents is an int32_t.
+#define TIERS (16)
+
+/* This structure contains a segment's line of the manifest. */
+typedef struct seg {
+	int32_t num;
+	int32_t ndocs;
+} seg_t;
+
+/* This structure contains a manifest: the number of the next segment and the live segments, oldest first. */
+typedef struct manifest {
+	int32_t next;
+	seg_t *segs;
+	int32_t nsegs;
+} manifest_t;
+
+/*
+ * This structure contains the hidden aspects of loaded segments: the index of each, oldest first,
+ * the segment holding the current version of each document, and the segment searched for any other.
+ */
+typedef struct privatesegindex {
+	index_t **indexes;
+	int32_t nsegs;
+	int32_t *owner;
+	int32_t nowner;
+	int32_t fallback;
+} privatesegindex_t;
+
+// Segment holding the current version of each document, and the places in the manifest of the segments being merged.
+static int32_t *mergeOwner, mergeNOwner, *mergePos;
+
+/*
+ * Builds the name of a file in the index directory.
+ */
+static void fileName(char *name, size_t size, const char *dirnm, const char *file) {
+	snprintf(name, size, "%s/%s", dirnm, file);
+}
+
+/*
+ * Builds the name of a segment's file, or of its list of documents with the suffix .docs.
+ */
+static void segName(char *name, size_t size, const char *dirnm, int32_t num, const char *suffix) {
+	snprintf(name, size, "%s/%d%s", dirnm, num, suffix);
+}
+
+/*
+ * Locks the index directory, shared for F_RDLCK or alone for F_WRLCK, waiting for it if need be.
+ * Outputs: the descriptor holding the lock, to be closed to release it; -1 on failure.
+ */
+static int lockDir(char *dirnm, short type) {
+	// Variable declarations.
+	char name[MAXLINE];
+	struct flock fl;
+	int fd;
+
+	// A directory that cannot be written to can still be read under a shared lock.
+	fileName(name, sizeof(name), dirnm, "lock");
+	if ((fd = open(name, O_RDWR | O_CREAT, 0666)) < 0 && (type != F_RDLCK || (fd = open(name, O_RDONLY)) < 0))
+		return -1;
+
+	memset(&fl, 0, sizeof(fl));
+	fl.l_type = type;
+	fl.l_whence = SEEK_SET;
+	while (fcntl(fd, F_SETLKW, &fl) != 0) {
+		if (errno != EINTR) {
+			close(fd);
+			return -1;
+		}
+	}
+
+	return fd;
+}
+
+/*
+ * Adds a segment to the end of a manifest.
+ * Outputs: 0 for success; non-zero otherwise.
+ */
+static int32_t addSeg(manifest_t *m, seg_t seg) {
+	// Variable declarations.
+	seg_t *segs;
+
+	if ((segs = (seg_t *)realloc(m->segs, sizeof(seg_t)*(m->nsegs + 1))) == NULL)
+		return 1;
+
+	m->segs = segs;
+	m->segs[m->nsegs++] = seg;
+	return 0;
+}
+
+/*
+ * Reads the manifest of an index directory; a directory without one has no segments.
+ * Outputs: 0 for success; non-zero otherwise, with the manifest left empty.
+ */
+static int32_t readManifest(char *dirnm, manifest_t *m) {
+	// Variable declarations.
+	char name[MAXLINE], line[MAXLINE];
+	FILE *mfile;
+	seg_t seg;
+
+	m->next = 0;
+	m->segs = NULL;
+	m->nsegs = 0;
+
+	fileName(name, sizeof(name), dirnm, "manifest");
+	if ((mfile = fopen(name, "r")) == NULL)
+		return errno != ENOENT;
+
+	if (fgets(line, sizeof(line), mfile) == NULL || strncmp(line, MAGIC, strlen(MAGIC)) != 0 || fscanf(mfile, "%d", &(m->next)) != 1) {
+		fclose(mfile);
+		return 1;
+	}
+
+	while (fscanf(mfile, "%d %d", &(seg.num), &(seg.ndocs)) == 2) {
+		if (addSeg(m, seg) != 0) {
+			free(m->segs);
+			m->segs = NULL;
+			m->nsegs = 0;
+			fclose(mfile);
+			return 1;
+		}
+	}
+
+	fclose(mfile);
+	return 0;
+}
+
+/*
+ * Writes the manifest of an index directory to a temporary file and renames it into place, so
+ * that it is never seen half written.
+ * Outputs: 0 for success; non-zero otherwise.
+ */
+static int32_t writeManifest(char *dirnm, manifest_t *m) {
+	// Variable declarations.
+	char tmpName[MAXLINE], name[MAXLINE];
+	FILE *mfile;
+	int32_t i;
+
+	fileName(tmpName, sizeof(tmpName), dirnm, "manifest.tmp");
+	fileName(name, sizeof(name), dirnm, "manifest");
+
+	if ((mfile = fopen(tmpName, "w")) == NULL)
+		return 1;
+
+	fprintf(mfile, "%s\n%d\n", MAGIC, m->next);
+	for (i = 0; i < m->nsegs; i++)
+		fprintf(mfile, "%d %d\n", m->segs[i].num, m->segs[i].ndocs);
+
+	if (ferror(mfile) || fclose(mfile) != 0)
+		return 1;
+
+	return rename(tmpName, name) != 0;
+}
+
+/*
+ * Reads the list of documents of a segment.
+ * Outputs: the number of documents, with the list in *docs to be freed by the caller; -1 on failure.
+ */
+static int32_t readDocs(char *dirnm, int32_t num, int32_t **docs) {
+	// Variable declarations.
+	char name[MAXLINE];
+	FILE *dfile;
+	int32_t id, n = 0, size = 0, *grown;
+
+	*docs = NULL;
+	segName(name, sizeof(name), dirnm, num, ".docs");
+	if ((dfile = fopen(name, "r")) == NULL)
+		return -1;
+
+	while (fscanf(dfile, "%d", &id) == 1) {
+		// Grow the list as needed.
+		if (n == size) {
+			size = size == 0 ? 64 : 2*size;
+			if ((grown = (int32_t *)realloc(*docs, size*sizeof(int32_t))) == NULL) {
+				free(*docs);
+				*docs = NULL;
+				fclose(dfile);
+				return -1;
+			}
+			*docs = grown;
+		}
+		(*docs)[n++] = id;
+	}
+
+	fclose(dfile);
+	return n;
+}
+
+/*
+ * Writes the list of documents of a segment.
+ * Outputs: 0 for success; non-zero otherwise.
+ */
+static int32_t writeDocs(char *dirnm, int32_t num, int32_t *docs, int32_t ndocs) {
+	// Variable declarations.
+	char name[MAXLINE];
+	FILE *dfile;
+	int32_t i;
+
+	segName(name, sizeof(name), dirnm, num, ".docs");
+	if ((dfile = fopen(name, "w")) == NULL)
+		return 1;
+
+	for (i = 0; i < ndocs; i++)
+		fprintf(dfile, "%d\n", docs[i]);
+
+	return ferror(dfile) | fclose(dfile);
+}
+
+/*
+ * Removes a segment's files.
+ */
+static void removeSeg(char *dirnm, int32_t num) {
+	// Variable declarations.
+	char name[MAXLINE];
+
+	segName(name, sizeof(name), dirnm, num, "");
+	remove(name);
+	segName(name, sizeof(name), dirnm, num, ".docs");
+	remove(name);
+}
+
+/*
+ * Finds, for each document, the newest of the segments of a manifest from place from on that holds it.
+ * Outputs: 0 for success, with the place of each document's segment, -1 for none, in *owner, indexed
+ *          by docID and to be freed by the caller, and its length in *nowner; non-zero otherwise.
+ */
+static int32_t mapOwners(char *dirnm, manifest_t *m, int32_t from, int32_t **owner, int32_t *nowner) {
+	// Variable declarations.
+	int32_t i, j, n, size, *docs, *grown;
+
+	*owner = NULL;
+	*nowner = 0;
+
+	// Later segments come later, so each document ends up with the newest holding it.
+	for (i = from; i < m->nsegs; i++) {
+		if ((n = readDocs(dirnm, m->segs[i].num, &docs)) < 0)
+			return 1;
+
+		for (j = 0; j < n; j++) {
+			if (docs[j] < 0)
+				continue;
+
+			// Grow the array as needed; documents in no segment have none.
+			if (docs[j] >= *nowner) {
+				size = 2*(*nowner) > docs[j] ? 2*(*nowner) : docs[j] + 1;
+				if ((grown = (int32_t *)realloc(*owner, size*sizeof(int32_t))) == NULL) {
+					free(docs);
+					return 1;
+				}
+				*owner = grown;
+				while (*nowner < size)
+					(*owner)[(*nowner)++] = -1;
+			}
+			(*owner)[docs[j]] = i;
+		}
+		free(docs);
+	}
+
+	return 0;
+}
+
+/*
+ * Gives the tier of a segment: the number of times its number of documents can be divided by MERGEFACTOR.
+ */
+static int32_t tierOf(int32_t ndocs) {
+	// Variable declarations.
+	int32_t tier;
+
+	for (tier = 0; ndocs >= MERGEFACTOR; tier++)
+		ndocs /= MERGEFACTOR;
+
+	return tier;
+}
+
+/*
+ * Picks the segments to merge next: the MERGEFACTOR oldest of the lowest tier that has that many.
+ * Outputs: the number of segments picked, with their places in the manifest, oldest first, in pos; 0 for none.
+ */
+static int32_t pick(manifest_t *m, int32_t *pos) {
+	// Variable declarations.
+	int32_t tier, i, n;
+
+	for (tier = 0; tier < TIERS; tier++) {
+		for (i = 0, n = 0; i < m->nsegs; i++) {
+			if (tierOf(m->segs[i].ndocs) == tier)
+				pos[n++] = i;
+			if (n == MERGEFACTOR)
+				return n;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Tells whether a merge keeps a document of one of the segments it merges: whether the segment holds its current version.
+ */
+static bool keepDoc(int32_t spill, int32_t doc) {
+	return doc >= 0 && doc < mergeNOwner && mergeOwner[doc] == mergePos[spill];
+}
+
+/*
+ * Merges the segments the merge policy picks, if there are any.
+ * Outputs: 0 if segments were merged; 1 if none needed to be; -1 on failure.
+ */
+static int32_t mergeOnce(char *dirnm) {
+	// Variable declarations.
+	manifest_t m;
+	seg_t seg;
+	char names[MERGEFACTOR][MAXLINE], *spillnms[MERGEFACTOR], name[MAXLINE];
+	int32_t pos[MERGEFACTOR], nums[MERGEFACTOR], i, j, n, k, ndocs, *docs, *merged = NULL, *grown;
+	bool ok;
+	int fd;
+
+	// Pick the segments and number the merged one with the directory locked.
+	if ((fd = lockDir(dirnm, F_WRLCK)) < 0)
+		return -1;
+
+	if (readManifest(dirnm, &m) != 0) {
+		close(fd);
+		return -1;
+	}
+
+	if ((n = pick(&m, pos)) == 0) {
+		free(m.segs);
+		close(fd);
+		return 1;
+	}
+
+	seg.num = m.next++;
+	ok = writeManifest(dirnm, &m) == 0;
+	close(fd);
+
+	// The segments are not changed once written, so they are read without the lock.
+	for (i = 0; i < n; i++) {
+		nums[i] = m.segs[pos[i]].num;
+		segName(names[i], sizeof(names[i]), dirnm, nums[i], "");
+		spillnms[i] = names[i];
+	}
+	ok = ok && mapOwners(dirnm, &m, pos[0], &mergeOwner, &mergeNOwner) == 0;
+	free(m.segs);
+
+	// Merge them, keeping from each the documents it holds the current version of; the merged segment holds all of those.
+	mergePos = pos;
+	segName(name, sizeof(name), dirnm, seg.num, "");
+	ok = ok && indexmergespills(spillnms, n, name, keepDoc) == 0;
+
+	seg.ndocs = 0;
+	for (i = 0; i < n && ok; i++) {
+		if ((ndocs = readDocs(dirnm, nums[i], &docs)) < 0 || (grown = (int32_t *)realloc(merged, sizeof(int32_t)*(seg.ndocs + ndocs + 1))) == NULL)
+			ok = false;
+		else
+			merged = grown;
+		for (j = 0; ok && j < ndocs; j++)
+			if (keepDoc(i, docs[j]))
+				merged[seg.ndocs++] = docs[j];
+		free(docs);
+	}
+	ok = ok && writeDocs(dirnm, seg.num, merged, seg.ndocs) == 0;
+
+	free(merged);
+	free(mergeOwner);
+	mergeOwner = NULL;
+	mergeNOwner = 0;
+
+	if (!ok) {
+		removeSeg(dirnm, seg.num);
+		return -1;
+	}
+
+	// Put the merged segment in the place of the newest it was merged from, unless it is empty, and drop the others.
+	if ((fd = lockDir(dirnm, F_WRLCK)) < 0 || readManifest(dirnm, &m) != 0) {
+		if (fd >= 0)
+			close(fd);
+		removeSeg(dirnm, seg.num);
+		return -1;
+	}
+
+	for (i = 0, k = 0; i < m.nsegs; i++) {
+		for (j = 0; j < n && m.segs[i].num != nums[j]; j++)
+			;
+		if (j == n)
+			m.segs[k++] = m.segs[i];
+		else if (j == n - 1 && seg.ndocs != 0)
+			m.segs[k++] = seg;
+	}
+	m.nsegs = k;
+
+	if (writeManifest(dirnm, &m) != 0) {
+		free(m.segs);
+		close(fd);
+		removeSeg(dirnm, seg.num);
+		return -1;
+	}
+
+	// No search can have the old segments open while the directory is locked.
+	for (i = 0; i < n; i++)
+		removeSeg(dirnm, nums[i]);
+	if (seg.ndocs == 0)
+		removeSeg(dirnm, seg.num);
+
+	free(m.segs);
+	close(fd);
+	return 0;
+}
+
+/*
+ * sgadd -- adds an index to a segmented index as its newest segment
+ * inputs: index directory; index; documents it covers; number of them
+ * outputs: 0 for success; non-zero otherwise
+ */
+int32_t sgadd(char *dirnm, index_t *index, int32_t *docs, int32_t ndocs) {
+	// Variable declarations.
+	struct stat dir;
+	manifest_t m;
+	seg_t seg;
+	char name[MAXLINE];
+	int32_t result = 1;
+	int fd;
+
+	if (dirnm == NULL || index == NULL || ndocs < 0 || (docs == NULL && ndocs > 0))
+		return 1;
+
+	// Create the directory if needed.
+	if ((stat(dirnm, &dir) != 0 || S_ISDIR(dir.st_mode) == 0) && mkdir(dirnm, 0777) != 0)
+		return 1;
+
+	if ((fd = lockDir(dirnm, F_WRLCK)) < 0)
+		return 1;
+
+	// Write the segment and its documents, then list it in the manifest.
+	if (readManifest(dirnm, &m) == 0) {
+		seg.num = m.next++;
+		seg.ndocs = ndocs;
+		segName(name, sizeof(name), dirnm, seg.num, "");
+
+		if (indexspill(index, name) == 0 && writeDocs(dirnm, seg.num, docs, ndocs) == 0 && addSeg(&m, seg) == 0 && writeManifest(dirnm, &m) == 0)
+			result = 0;
+		else
+			removeSeg(dirnm, seg.num);
+	}
+
+	free(m.segs);
+	close(fd);
+	return result;
+}
+
+/*
+ * sgmerge -- merges the segments of a segmented index by tiers
+ * inputs: index directory; whether to merge in a process of its own
+ * outputs: 0 for success, or for the merge started; non-zero otherwise
+ */
+int32_t sgmerge(char *dirnm, bool background) {
+	// Variable declarations.
+	char name[MAXLINE];
+	struct flock fl;
+	pid_t pid;
+	int fd, err;
+	int32_t result;
+
+	if (dirnm == NULL)
+		return 1;
+
+	// The process merging goes on by itself; the caller only starts it.
+	if (background) {
+		if ((pid = fork()) < 0)
+			return 1;
+		if (pid > 0)
+			return 0;
+		_exit(sgmerge(dirnm, false));
+	}
+
+	// Only one process merges at a time; one that finds another merging leaves the merging to it.
+	fileName(name, sizeof(name), dirnm, "merging");
+	if ((fd = open(name, O_RDWR | O_CREAT, 0666)) < 0)
+		return 1;
+
+	memset(&fl, 0, sizeof(fl));
+	fl.l_type = F_WRLCK;
+	fl.l_whence = SEEK_SET;
+	if (fcntl(fd, F_SETLK, &fl) != 0) {
+		err = errno;
+		close(fd);
+		return err != EACCES && err != EAGAIN;
+	}
+
+	// Merge until no tier is full.
+	while ((result = mergeOnce(dirnm)) == 0)
+		;
+
+	close(fd);
+	return result < 0;
+}
+
+/*
+ * sgload -- loads every segment of a segmented index, or an index file as the only segment
+ * inputs: index directory or file
+ * outputs: the segments; NULL on failure
+ */
+segindex_t *sgload(char *name) {
+	// Variable declarations.
+	privatesegindex_t *psi;
+	struct stat st;
+	manifest_t m;
+	char segnm[MAXLINE];
+	bool ok = false;
+	int fd;
+
+	if (name == NULL || stat(name, &st) != 0 || (psi = (privatesegindex_t *)calloc(1, sizeof(privatesegindex_t))) == NULL)
+		return NULL;
+
+	// An index file holds every document.
+	if (S_ISDIR(st.st_mode) == 0) {
+		if ((psi->indexes = (index_t **)malloc(sizeof(index_t *))) == NULL || (psi->indexes[0] = indexload(name)) == NULL) {
+			sgclose(psi);
+			return NULL;
+		}
+		psi->nsegs = 1;
+		psi->fallback = 0;
+		return (segindex_t *)psi;
+	}
+
+	// Keep merges from removing segments while they are read.
+	psi->fallback = -1;
+	fd = lockDir(name, F_RDLCK);
+
+	if (readManifest(name, &m) == 0 && (psi->indexes = (index_t **)calloc(m.nsegs + 1, sizeof(index_t *))) != NULL
+	    && mapOwners(name, &m, 0, &(psi->owner), &(psi->nowner)) == 0) {
+		for (psi->nsegs = 0; psi->nsegs < m.nsegs; psi->nsegs++) {
+			segName(segnm, sizeof(segnm), name, m.segs[psi->nsegs].num, "");
+			if ((psi->indexes[psi->nsegs] = indexload(segnm)) == NULL)
+				break;
+		}
+		ok = (psi->nsegs == m.nsegs);
+	}
+
+	free(m.segs);
+	if (fd >= 0)
+		close(fd);
+
+	if (!ok) {
+		sgclose(psi);
+		return NULL;
+	}
+
+	return (segindex_t *)psi;
+}
+
+/*
+ * sgdoc -- returns the count of a word in a document from the newest segment holding it
+ * inputs: loaded segments; word; docID
+ * outputs: the document's count; NULL if the word is not in it
+ */
+docCount_t *sgdoc(segindex_t *sip, char *word, int32_t id) {
+	// Variable declarations.
+	privatesegindex_t *psi = (privatesegindex_t *)sip;
+	wordQ_t *wq;
+	int32_t s;
+
+	if (psi == NULL || word == NULL)
+		return NULL;
+
+	// Postings of the document in older segments are of versions indexed since.
+	s = (id >= 0 && id < psi->nowner && psi->owner[id] >= 0) ? psi->owner[id] : psi->fallback;
+	if (s < 0 || (wq = indexfind(psi->indexes[s], word)) == NULL)
+		return NULL;
+
+	return indexdoc(wq, id);
+}
+
+/*
+ * sgclose -- frees loaded segments
+ * inputs: segments
+ * outputs: none
+ */
+void sgclose(segindex_t *sip) {
+	// Variable declarations.
+	privatesegindex_t *psi = (privatesegindex_t *)sip;
+	int32_t i;
+
+	if (psi == NULL)
+		return;
+
+	for (i = 0; i < psi->nsegs; i++)
+		indexclose(psi->indexes[i]);
+
+	free(psi->indexes);
+	free(psi->owner);
+	free(psi);
+}
@@ -0,0 +1,67 @@
+#pragma once
+/*
+ * segment.h --- an index kept as a set of immutable segments
+ *
+ * Author: Joshua M. Meise
+ * Created: 11-20-2023
+ * Version: 1.0
+ *
+ * Description: A segmented index is a directory. Each segment is an index file over some documents,
+ *              with its words sorted (see indexspill), named by its number, and the list of those
+ *              documents in <number>.docs; neither is changed once written. The manifest lists the
+ *              live segments, oldest first, and is replaced atomically:
+ *                TSE-SEGMENTS 1
+ *                <number of the next segment>
+ *                <segment number> <number of documents>    one line per segment
+ *              A document indexed again goes into a new segment, and its postings in older ones are
+ *              no longer searched: a document is searched in the newest segment holding it. Merging
+ *              segments drops those postings, so that the index does not grow without end.
+ *
+ *              Segments are merged by tiers: a segment of fewer than 4 documents is in tier 0, one of
+ *              fewer than 16 in tier 1, and so on; whenever a tier has 4 segments they are merged into
+ *              one, which is usually in the next tier up. A document is thus merged again about once
+ *              each time the index grows fourfold.
+ *
+ *              Changes to the manifest hold a lock on the file lock in the directory, and loading the
+ *              segments holds it shared, so segments can be added, merged and searched at once.
+ *
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <index.h>
+
+/* the representation of loaded segments is hidden from users of the module */
+typedef void segindex_t;
+
+/*
+ * sgadd -- adds an index over documents docs, ndocs of them, to the segmented index in directory
+ * dirnm as its newest segment, creating the directory if needed; the index's postings of any other
+ * document are not searched
+ * returns: 0 for success; non-zero otherwise
+ */
+int32_t sgadd(char *dirnm, index_t *index, int32_t *docs, int32_t ndocs);
+
+/*
+ * sgmerge -- merges the segments of the segmented index in directory dirnm until no tier has 4;
+ * in the background, in a process of its own, if asked to, so that it goes on after the caller
+ * exits. Only one process merges an index at a time; another started meanwhile does nothing.
+ * returns: 0 for success, or for the merge started; non-zero otherwise
+ */
+int32_t sgmerge(char *dirnm, bool background);
+
+/*
+ * sgload -- loads every segment of the segmented index in directory name; if name is an index
+ * file instead, it is loaded as the only segment, holding every document
+ * returns: the segments; NULL on failure
+ */
+segindex_t *sgload(char *name);
+
+/*
+ * sgdoc -- returns the count of a word in a document, from the newest segment holding the
+ * document; NULL if the word is not in it
+ */
+docCount_t *sgdoc(segindex_t *sip, char *word, int32_t id);
+
+/* sgclose -- frees loaded segments */
+void sgclose(segindex_t *sip);
@@ -0,0 +1,255 @@
+/*
+ * simhash.c --- implements the simhash.h interface
+ *
+ * Author: Joshua M. Meise
+ * Created: 11-08-2023
+ * Version: 1.0
+ *
+ * Description: Each word is hashed with urlfingerprint, and every bit of the SimHash is set if
+ *              that bit is set in more of the page's word hashes than it is clear. The index keeps
+ *              every fingerprint once and, for each band, a chained hash table from the band's bits
+ *              to the fingerprints having them; the tables double once they hold as many
+ *              fingerprints as they have buckets.
+ *
+ */
+
+#include <simhash.h>
+#include <urlset.h>
+#include <index.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* This structure contains one band of the fingerprint and the table indexing it. */
+typedef struct band {
+	int32_t shift;
+	uint64_t mask;
+	int32_t *heads;
+} band_t;
+
+/* This structure contains the hidden aspects of a SimHash index. */
+typedef struct privatesimindex {
+	int32_t distance;
+	int32_t bands;
+	band_t band[SIMHASH_MAXDISTANCE + 1];
+	uint32_t size;
+	uint64_t *fps;
+	int32_t *ids;
+	int32_t *next;
+	uint32_t count;
+	uint32_t capacity;
+} privatesimindex_t;
+
+// Words taken from a page at a time.
+#define WORDBATCH (256)
+
+/*
+ * returns the SimHash of the words of a page
+ */
+uint64_t simhash(webpage_t *page, int32_t *words) {
+	// Variable declarations.
+	webpage_word_t batch[WORDBATCH];
+	int32_t votes[64], size = 0, i, j;
+	int pos = 0, n;
+	char *html = webpage_getHTML(page), *word = NULL;
+	uint64_t h, fp = 0;
+
+	memset(votes, 0, sizeof(votes));
+	*words = 0;
+
+	// Every word votes on every bit.
+	while ((n = webpage_getWords(page, &pos, batch, WORDBATCH)) > 0) {
+		for (j = 0; j < n; j++) {
+			if (indexword(html, &batch[j], &word, &size) != 0)
+				continue;
+
+			(*words)++;
+			h = urlfingerprint(word, batch[j].len);
+			for (i = 0; i < 64; i++)
+				votes[i] += (h >> i) & 1 ? 1 : -1;
+		}
+	}
+	free(word);
+
+	// A bit is set if most words set it.
+	for (i = 0; i < 64; i++)
+		if (votes[i] > 0)
+			fp |= 1ULL << i;
+
+	return fp;
+}
+
+/*
+ * returns the Hamming distance between two fingerprints
+ */
+int32_t sidistance(uint64_t a, uint64_t b) {
+	// Variable declarations.
+	uint64_t x = a ^ b;
+	int32_t bits = 0;
+
+	// Clear the lowest set bit until none is left.
+	for (; x != 0; x &= x - 1)
+		bits++;
+
+	return bits;
+}
+
+/*
+ * Bucket of a band's bits in a table of the given size.
+ */
+static uint32_t bucket(band_t *b, uint64_t fp, uint32_t size) {
+	return (uint32_t)((((fp >> b->shift) & b->mask)*0x9e3779b97f4a7c15ULL) >> 32) & (size - 1);
+}
+
+/*
+ * Links fingerprint e into the table of every band.
+ */
+static void linkEntry(privatesimindex_t *psi, uint32_t e) {
+	// Variable declarations.
+	int32_t b;
+	uint32_t k;
+
+	for (b = 0; b < psi->bands; b++) {
+		k = bucket(&psi->band[b], psi->fps[e], psi->size);
+		psi->next[e*psi->bands + b] = psi->band[b].heads[k];
+		psi->band[b].heads[k] = e;
+	}
+}
+
+/*
+ * Allocates tables of the given size for every band, all empty.
+ * Outputs: 0 for success, non-zero otherwise.
+ */
+static int32_t makeTables(privatesimindex_t *psi, uint32_t size) {
+	// Variable declarations.
+	int32_t b;
+	uint32_t k;
+
+	for (b = 0; b < psi->bands; b++) {
+		free(psi->band[b].heads);
+		if ((psi->band[b].heads = (int32_t *)malloc(size*sizeof(int32_t))) == NULL)
+			return 1;
+		for (k = 0; k < size; k++)
+			psi->band[b].heads[k] = -1;
+	}
+	psi->size = size;
+
+	return 0;
+}
+
+/*
+ * opens an empty index
+ * inputs: Hamming distance to search within
+ * outputs: the index, NULL on failure
+ */
+simindex_t *siopen(int32_t distance) {
+	// Variable declarations.
+	privatesimindex_t *psi;
+	int32_t b, start, width;
+
+	if (distance < 0 || distance > SIMHASH_MAXDISTANCE)
+		return NULL;
+
+	if ((psi = (privatesimindex_t *)calloc(1, sizeof(privatesimindex_t))) == NULL)
+		return NULL;
+
+	// Cut the 64 bits into distance + 1 bands as evenly as possible.
+	psi->distance = distance;
+	psi->bands = distance + 1;
+	for (b = 0, start = 0; b < psi->bands; b++, start += width) {
+		width = 64/psi->bands + (b < 64%psi->bands ? 1 : 0);
+		psi->band[b].shift = start;
+		psi->band[b].mask = width == 64 ? ~0ULL : (1ULL << width) - 1;
+	}
+
+	if (makeTables(psi, 64) != 0) {
+		siclose(psi);
+		return NULL;
+	}
+
+	return (simindex_t *)psi;
+}
+
+/*
+ * closes an index and frees everything in it
+ * inputs: index to close
+ * outputs: none
+ */
+void siclose(simindex_t *sip) {
+	// Variable declarations.
+	privatesimindex_t *psi = (privatesimindex_t *)sip;
+	int32_t b;
+
+	if (psi == NULL)
+		return;
+
+	for (b = 0; b < psi->bands; b++)
+		free(psi->band[b].heads);
+	free(psi->fps);
+	free(psi->ids);
+	free(psi->next);
+	free(psi);
+}
+
+/*
+ * adds a fingerprint
+ * inputs: index, fingerprint, id of its page
+ * outputs: 0 for success, non-zero otherwise
+ */
+int32_t siadd(simindex_t *sip, uint64_t fp, int32_t id) {
+	// Variable declarations.
+	privatesimindex_t *psi = (privatesimindex_t *)sip;
+	uint32_t e;
+	void *p;
+
+	// Make room for one more fingerprint.
+	if (psi->count == psi->capacity) {
+		psi->capacity = psi->capacity == 0 ? 64 : 2*psi->capacity;
+		if ((p = realloc(psi->fps, psi->capacity*sizeof(uint64_t))) == NULL)
+			return 1;
+		psi->fps = (uint64_t *)p;
+		if ((p = realloc(psi->ids, psi->capacity*sizeof(int32_t))) == NULL)
+			return 1;
+		psi->ids = (int32_t *)p;
+		if ((p = realloc(psi->next, psi->capacity*psi->bands*sizeof(int32_t))) == NULL)
+			return 1;
+		psi->next = (int32_t *)p;
+	}
+
+	e = psi->count++;
+	psi->fps[e] = fp;
+	psi->ids[e] = id;
+
+	// Keep chains short by doubling the tables when they are full.
+	if (psi->count > psi->size) {
+		if (makeTables(psi, 2*psi->size) != 0)
+			return 1;
+		for (e = 0; e < psi->count; e++)
+			linkEntry(psi, e);
+	}
+	else
+		linkEntry(psi, e);
+
+	return 0;
+}
+
+/*
+ * looks for a close fingerprint
+ * inputs: index, fingerprint
+ * outputs: id of a fingerprint within the distance, 0 if there is none
+ */
+int32_t sifind(simindex_t *sip, uint64_t fp) {
+	// Variable declarations.
+	privatesimindex_t *psi = (privatesimindex_t *)sip;
+	band_t *bp;
+	int32_t b, e;
+
+	// Only fingerprints agreeing with fp on some band can be close enough.
+	for (b = 0; b < psi->bands; b++) {
+		bp = &psi->band[b];
+		for (e = bp->heads[bucket(bp, fp, psi->size)]; e != -1; e = psi->next[e*psi->bands + b])
+			if ((((psi->fps[e] ^ fp) >> bp->shift) & bp->mask) == 0 && sidistance(psi->fps[e], fp) <= psi->distance)
+				return psi->ids[e];
+	}
+
+	return 0;
+}
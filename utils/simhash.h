@@ -0,0 +1,56 @@
+#pragma once
+/*
+ * simhash.h --- public interface to the near-duplicate detection module
+ *
+ * Author: Joshua M. Meise
+ * Created: 11-08-2023
+ * Version: 1.0
+ *
+ * Description: A SimHash is a 64-bit fingerprint of the words on a page in which similar pages
+ *              differ in few bits, so near-duplicates are pages whose fingerprints are within a
+ *              small Hamming distance of each other. A SimHash index holds the fingerprints of the
+ *              pages saved so far and finds one close to a new fingerprint without comparing
+ *              against every page: the 64 bits are cut into distance + 1 bands, and any two
+ *              fingerprints within the distance agree exactly on at least one band.
+ *
+ */
+
+#include <stdint.h>
+#include <webpage.h>
+
+/* the index representation is hidden from users of the module */
+typedef void simindex_t;
+
+/* Largest Hamming distance an index can search within. */
+#define SIMHASH_MAXDISTANCE 15
+
+/*
+ * simhash -- returns the SimHash of the words of a fetched page; every word of at least
+ * three letters counts once per occurrence, regardless of case, and *words is set to the
+ * number of them. A page with no such word has the SimHash 0, which says nothing about it.
+ */
+uint64_t simhash(webpage_t *page, int32_t *words);
+
+/* sidistance -- returns the number of bits in which two fingerprints differ */
+int32_t sidistance(uint64_t a, uint64_t b);
+
+/*
+ * siopen -- opens an empty index finding fingerprints within distance bits of each other
+ * returns: the index, NULL if distance is out of range or on failure
+ */
+simindex_t *siopen(int32_t distance);
+
+/* siclose -- closes an index and frees everything in it */
+void siclose(simindex_t *sip);
+
+/*
+ * siadd -- adds the fingerprint of a page saved under id
+ * returns: 0 for success; non-zero otherwise
+ */
+int32_t siadd(simindex_t *sip, uint64_t fp, int32_t id);
+
+/*
+ * sifind -- looks for a fingerprint within the index's distance of fp
+ * returns: the id it was added with, 0 if there is none
+ */
+int32_t sifind(simindex_t *sip, uint64_t fp);
@@ -0,0 +1,99 @@
+/*
+ * stopgen.c --- generates the perfect hash table of stopwords used by analyze.c
+ *
+ * Author: Joshua M. Meise
+ * Created: 11-14-2023
+ * Version: 1.0
+ *
+ * Description: Reads a list of stopwords, one lowercase word per line, and prints a C header holding
+ *              the words, their webpage_termHash hashes and a table of STOPSLOTS slots in which every
+ *              word has a slot of its own: a word's slot is the top bits of its hash times a multiplier,
+ *              and multipliers are tried until no two words share a slot. The indexers already have
+ *              the hash of every word they find, so checking one against the table is a multiply, a
+ *              load and, only when the hashes match, a string comparison. Run by "make stopwords".
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#include <webpage.h>
+
+// Usage message printed on any bad argument.
+#define USAGE "usage: stopgen <stopwords>\n"
+
+// Number of slots in the table, and the bits of a slot number.
+#define STOPSLOTS 1024
+#define STOPBITS 10
+
+// Most words the table can hold; slots hold a word's number plus one.
+#define MAXSTOP 255
+
+// Longest stopword.
+#define MAXLEN 32
+
+int main(int argc, char *argv[]) {
+	// Variable declarations.
+	char words[MAXSTOP][MAXLEN + 2];
+	uint32_t hashes[MAXSTOP], mul, state;
+	uint8_t slots[STOPSLOTS];
+	int32_t n, i, len, tries;
+	FILE *ifile;
+
+	if (argc != 2 || (ifile = fopen(argv[1], "r")) == NULL) {
+		printf(USAGE);
+		exit(EXIT_FAILURE);
+	}
+
+	// Read the words, which must be lowercase letters like every indexed word.
+	for (n = 0; n < MAXSTOP && fgets(words[n], sizeof(words[n]), ifile) != NULL; n++) {
+		words[n][strcspn(words[n], "\n")] = '\0';
+		for (len = 0; words[n][len] != '\0' && islower((unsigned char)words[n][len]); len++)
+			;
+		if (len == 0 || words[n][len] != '\0') {
+			fprintf(stderr, "stopgen: bad word %s\n", words[n]);
+			exit(EXIT_FAILURE);
+		}
+		hashes[n] = webpage_termHash(words[n], len);
+	}
+	fclose(ifile);
+
+	// Try odd multipliers until every word lands in a slot of its own.
+	for (tries = 0, state = 1; ; tries++) {
+		state = state*1664525u + 1013904223u;
+		mul = state | 1;
+		memset(slots, 0, sizeof(slots));
+		for (i = 0; i < n && slots[(hashes[i]*mul) >> (32 - STOPBITS)] == 0; i++)
+			slots[(hashes[i]*mul) >> (32 - STOPBITS)] = i + 1;
+		if (i == n)
+			break;
+		if (tries == 10000000) {
+			fprintf(stderr, "stopgen: no perfect hash found\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	printf("/*\n * stopwords.h --- generated by stopgen from stopwords.txt; do not edit, run \"make stopwords\"\n */\n\n");
+	printf("// A word's slot in stopSlot is the top STOPBITS bits of its webpage_termHash times STOPMUL.\n");
+	printf("#define STOPWORDS %d\n#define STOPBITS %d\n#define STOPMUL 0x%08xu\n\n", n, STOPBITS, mul);
+
+	printf("static const char *stopWords[STOPWORDS] = {");
+	for (i = 0; i < n; i++)
+		printf("%s\"%s\",", i%8 == 0 ? "\n\t" : " ", words[i]);
+	printf("\n};\n\n");
+
+	printf("static const uint32_t stopHash[STOPWORDS] = {");
+	for (i = 0; i < n; i++)
+		printf("%s0x%08xu,", i%6 == 0 ? "\n\t" : " ", hashes[i]);
+	printf("\n};\n\n");
+
+	// Slots hold a word's number plus one, 0 when empty.
+	printf("static const uint8_t stopSlot[1 << STOPBITS] = {");
+	for (i = 0; i < STOPSLOTS; i++)
+		printf("%s%d,", i%16 == 0 ? "\n\t" : " ", slots[i]);
+	printf("\n};\n");
+
+	exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,116 @@
+/*
+ * stopwords.h --- generated by stopgen from stopwords.txt; do not edit, run "make stopwords"
+ */
+
+// A word's slot in stopSlot is the top STOPBITS bits of its webpage_termHash times STOPMUL.
+#define STOPWORDS 115
+#define STOPBITS 10
+#define STOPMUL 0x97cf9547u
+
+static const char *stopWords[STOPWORDS] = {
+	"myself", "our", "ours", "ourselves", "you", "your", "yours", "yourself",
+	"yourselves", "him", "his", "himself", "she", "her", "hers", "herself",
+	"its", "itself", "they", "them", "their", "theirs", "themselves", "what",
+	"which", "who", "whom", "this", "that", "these", "those", "are",
+	"was", "were", "been", "being", "have", "has", "had", "having",
+	"does", "did", "doing", "the", "and", "but", "because", "until",
+	"while", "about", "against", "between", "into", "through", "during", "before",
+	"after", "above", "below", "from", "down", "out", "off", "over",
+	"under", "again", "further", "then", "once", "here", "there", "when",
+	"where", "why", "how", "all", "any", "both", "each", "few",
+	"more", "most", "other", "some", "such", "nor", "not", "only",
+	"own", "same", "than", "too", "very", "can", "will", "just",
+	"don", "should", "now", "aren", "couldn", "didn", "doesn", "hadn",
+	"hasn", "haven", "isn", "mightn", "mustn", "needn", "shan", "shouldn",
+	"wasn", "weren", "wouldn",
+};
+
+static const uint32_t stopHash[STOPWORDS] = {
+	0xe1a6e2f0u, 0x0fdafabfu, 0x9052e41fu, 0xc2cf8b50u, 0x203bec53u, 0x097045c1u,
+	0xfbdb6616u, 0x2b815879u, 0x0551e853u, 0x68d2157du, 0xda787786u, 0x33a23375u,
+	0x901e6f55u, 0x7e9b54efu, 0x2b488012u, 0xd7f3e7a9u, 0x3f411042u, 0x7876fdbbu,
+	0xbe49150fu, 0x46b3d9deu, 0x09ee6d2cu, 0xcbeea1dau, 0xae2b53d9u, 0xc1b1a86au,
+	0x770d46aeu, 0xffea6769u, 0x0e36226du, 0xbd9e65fcu, 0x3b59214du, 0x27a6d0ebu,
+	0xf2b09ad9u, 0x0c37ab13u, 0x4ee389f8u, 0x6f61bdb5u, 0xfbfe4380u, 0xf2ca8964u,
+	0x7d02eb2au, 0xb4dd7d00u, 0xc5430da3u, 0x9fa280f7u, 0x2409a15fu, 0x80bb187du,
+	0x44cad4e2u, 0x36300536u, 0xbdfe289fu, 0x325a39fdu, 0xced20a13u, 0x2e706b09u,
+	0x3a7b012cu, 0x9f671c93u, 0x3730abb4u, 0xcd6122b2u, 0xa9475448u, 0x3ffba31cu,
+	0x887c80b2u, 0xc3084df4u, 0xa4e28376u, 0x3e98f880u, 0x1d80cc0cu, 0x7c98023au,
+	0xb905340fu, 0xdde357e1u, 0xbfb8173fu, 0xa8080c5du, 0x3018f1d2u, 0xab15aafbu,
+	0x0c3b7365u, 0x22f7ad96u, 0x491b15b4u, 0x87ef96dbu, 0x65a44a1fu, 0xbf8bf348u,
+	0xe471f773u, 0x3cb3dedcu, 0xdd03177au, 0x17b77f02u, 0x76a8afbbu, 0x771a71d6u,
+	0x09a0dbe9u, 0x4b65f593u, 0x87bb0813u, 0xd2679f50u, 0x6702809eu, 0x9315cac4u,
+	0xe73fbb22u, 0x0313336du, 0xdf73127eu, 0x7af0893du, 0x58a52d94u, 0x30dfcf7au,
+	0xc65873edu, 0xd961631cu, 0x33894530u, 0xf427fc81u, 0xcc1407c3u, 0x1c441235u,
+	0x37e5e608u, 0x6a0db81du, 0x381575b6u, 0x6a63ff12u, 0xa15174c7u, 0xc8c6cb94u,
+	0xee627bf7u, 0x30a39631u, 0xaa4613b8u, 0x26688378u, 0x8b28807fu, 0xe8bd4b15u,
+	0x919ced74u, 0x323297c9u, 0xa3cffbd9u, 0xebe063f5u, 0x6a830a1du, 0x08365426u,
+	0xecb70999u,
+};
+
+static const uint8_t stopSlot[1 << STOPBITS] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 3,
+	0, 0, 0, 0, 0, 0, 91, 0, 0, 0, 0, 0, 0, 0, 0, 71,
+	97, 0, 0, 0, 50, 0, 0, 0, 75, 60, 84, 0, 44, 0, 0, 88,
+	0, 104, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 7, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 53, 0, 0, 0, 0, 0, 0, 0, 0, 0, 113, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 41, 0, 0, 0, 0, 111, 0,
+	0, 0, 0, 0, 42, 0, 0, 18, 0, 0, 0, 0, 0, 0, 64, 0,
+	0, 0, 0, 0, 0, 0, 109, 0, 38, 0, 0, 0, 0, 0, 0, 33,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 48, 0, 0, 0, 14,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 19, 0,
+	0, 0, 0, 0, 115, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 6, 0, 0, 0, 0, 0, 0, 0, 0, 59, 0, 0, 0,
+	0, 83, 87, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 81, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 94, 45, 0, 0, 76, 0, 0, 8, 65, 0, 0, 2, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 63, 0, 0, 0, 0, 0,
+	0, 0, 0, 61, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 37, 36,
+	0, 102, 0, 0, 0, 0, 31, 0, 0, 70, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 23, 0, 0, 0, 0, 0, 0, 0, 32, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 12, 0, 0, 0, 0, 0, 0, 0, 0, 114, 0, 0, 112, 0,
+	0, 0, 0, 0, 103, 66, 0, 0, 0, 0, 0, 0, 0, 55, 0, 0,
+	15, 98, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 11, 0, 0, 0, 0, 0, 0, 20, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 96, 0, 0, 93, 0, 0, 0, 0, 0, 0, 10,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 57,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 77, 105, 17, 0, 0, 0, 0, 0, 74, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 25, 0,
+	80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 52, 90, 0, 0,
+	79, 0, 0, 0, 0, 0, 95, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 106, 0, 0, 0, 100, 43, 0, 0, 99, 0,
+	27, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 85, 46, 0, 0, 0, 0, 0, 0, 0, 0, 73, 0,
+	0, 54, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 92, 0, 0, 0, 0, 0, 30, 62, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 51, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 110, 0, 4, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	82, 0, 0, 0, 0, 0, 0, 0, 0, 29, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 68, 0, 0, 0, 0, 0, 78, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 49, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 21, 0, 0, 0, 0, 0, 69, 0, 0, 0, 72, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 108, 0, 0, 0, 24, 0, 0, 40,
+	0, 0, 58, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 13,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 16, 0, 0, 0,
+	0, 0, 0, 0, 0, 5, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	89, 67, 0, 56, 0, 0, 0, 0, 0, 0, 0, 0, 28, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 86, 0, 0,
+	0, 39, 22, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 34,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 101, 0, 0, 26, 35, 0, 0, 9, 47, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 107, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
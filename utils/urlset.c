@@ -0,0 +1,324 @@
+/*
+ * urlset.c --- implements the urlset.h interface
+ *
+ * Author: Joshua M. Meise
+ * Created: 11-04-2023
+ * Version: 1.0
+ *
+ * Description: Fingerprints live in a power-of-two array probed linearly; zero marks an empty
+ *              slot, so a fingerprint of zero is stored as one. The array doubles whenever it
+ *              is three quarters full. The optional Bloom filter derives its bit positions from
+ *              the two halves of the fingerprint; it doubles with the array and is rebuilt from the
+ *              fingerprints in it, so that it keeps the same number of bits per URL as the set grows.
+ *
+ */
+
+#include <urlset.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* This structure contains the hidden aspects of a URL set. */
+typedef struct privateurlset {
+	uint64_t *slots;
+	uint32_t size;
+	uint32_t count;
+	uint64_t *bloom;
+	uint64_t bloomBits;
+	uint32_t hashes;
+} privateurlset_t;
+
+/*
+ * urlfingerprint -- FNV-1a over the URL, followed by a mixing step so that every bit of the
+ * result depends on every character (URLs sharing a long prefix differ only near the end).
+ */
+uint64_t urlfingerprint(const char *url, size_t len) {
+	// Variable declarations.
+	uint64_t h = 0xcbf29ce484222325ULL;
+	size_t i;
+
+	// FNV-1a.
+	for (i = 0; i < len; i++) {
+		h ^= (unsigned char)url[i];
+		h *= 0x100000001b3ULL;
+	}
+
+	// Final avalanche.
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+
+	// Zero marks an empty slot.
+	return h == 0 ? 1 : h;
+}
+
+/*
+ * Finds the slot holding a fingerprint, or the empty slot where it belongs.
+ */
+static uint64_t *probe(privateurlset_t *pus, uint64_t fp) {
+	// Variable declarations.
+	uint32_t mask = pus->size - 1, i;
+
+	for (i = (uint32_t)fp & mask; pus->slots[i] != 0 && pus->slots[i] != fp; i = (i + 1) & mask)
+		;
+
+	return &pus->slots[i];
+}
+
+/*
+ * Bit i of the Bloom filter for a fingerprint, by double hashing.
+ */
+static uint64_t bloomBit(privateurlset_t *pus, uint64_t fp, uint32_t i) {
+	return ((fp & 0xffffffffULL) + i*((fp >> 32) | 1)) % pus->bloomBits;
+}
+
+/*
+ * Sets the Bloom bits of a fingerprint.
+ */
+static void setBloom(privateurlset_t *pus, uint64_t fp) {
+	// Variable declarations.
+	uint64_t bit;
+	uint32_t i;
+
+	for (i = 0; i < pus->hashes; i++) {
+		bit = bloomBit(pus, fp, i);
+		pus->bloom[bit/64] |= 1ULL << (bit%64);
+	}
+}
+
+/*
+ * Doubles the size of the table and reinserts every fingerprint.
+ * Outputs: 0 for success, non-zero otherwise.
+ */
+static int32_t grow(privateurlset_t *pus) {
+	// Variable declarations.
+	uint64_t *old = pus->slots, *bloom;
+	uint32_t oldSize = pus->size, i;
+
+	// Allocate the bigger, empty table.
+	if ((pus->slots = (uint64_t *)calloc(2*oldSize, sizeof(uint64_t))) == NULL) {
+		pus->slots = old;
+		return 1;
+	}
+	pus->size = 2*oldSize;
+
+	// Reinsert everything.
+	for (i = 0; i < oldSize; i++)
+		if (old[i] != 0)
+			*probe(pus, old[i]) = old[i];
+
+	free(old);
+
+	// Double the Bloom filter too and set the bits of every fingerprint in it; if there is no room the old one,
+	// fuller but still right, is kept.
+	if (pus->bloomBits > 0 && (bloom = (uint64_t *)calloc(2*pus->bloomBits/64, sizeof(uint64_t))) != NULL) {
+		free(pus->bloom);
+		pus->bloom = bloom;
+		pus->bloomBits *= 2;
+		for (i = 0; i < pus->size; i++)
+			if (pus->slots[i] != 0)
+				setBloom(pus, pus->slots[i]);
+	}
+
+	return 0;
+}
+
+/*
+ * opens an empty set
+ * inputs: expected number of URLs, Bloom filter bits per URL
+ * outputs: pointer to the new set, NULL on failure
+ */
+urlset_t *usopen(uint32_t hint, uint32_t bloombits) {
+	// Variable declarations.
+	privateurlset_t *pus;
+	uint32_t size;
+
+	if ((pus = (privateurlset_t *)malloc(sizeof(privateurlset_t))) == NULL)
+		return NULL;
+
+	// Smallest power of two that holds hint fingerprints below the growth threshold.
+	for (size = 16; size/4*3 <= hint; size *= 2)
+		;
+
+	if ((pus->slots = (uint64_t *)calloc(size, sizeof(uint64_t))) == NULL) {
+		free(pus);
+		return NULL;
+	}
+	pus->size = size;
+	pus->count = 0;
+
+	// Size the Bloom filter, using the number of hashes that minimises false positives (bits * ln 2).
+	pus->bloom = NULL;
+	pus->bloomBits = 0;
+	pus->hashes = 0;
+	if (bloombits > 0) {
+		pus->bloomBits = (uint64_t)(hint > 0 ? hint : 1)*bloombits;
+		pus->bloomBits = (pus->bloomBits + 63)/64*64;
+		pus->hashes = (uint32_t)(bloombits*0.693 + 0.5);
+		if (pus->hashes < 1)
+			pus->hashes = 1;
+
+		if ((pus->bloom = (uint64_t *)calloc(pus->bloomBits/64, sizeof(uint64_t))) == NULL) {
+			free(pus->slots);
+			free(pus);
+			return NULL;
+		}
+	}
+
+	return (urlset_t *)pus;
+}
+
+/*
+ * closes a set and frees everything in it
+ * inputs: set to close
+ * outputs: none
+ */
+void usclose(urlset_t *usp) {
+	privateurlset_t *pus = (privateurlset_t *)usp;
+
+	if (pus == NULL)
+		return;
+
+	free(pus->slots);
+	free(pus->bloom);
+	free(pus);
+}
+
+/*
+ * checks for a fingerprint
+ * inputs: set, fingerprint
+ * outputs: true if the fingerprint is in the set
+ */
+bool uscontainsfp(urlset_t *usp, uint64_t fp) {
+	// Variable declarations.
+	privateurlset_t *pus = (privateurlset_t *)usp;
+	uint64_t bit;
+	uint32_t i;
+
+	// Any clear Bloom bit proves the fingerprint was never added.
+	for (i = 0; i < pus->hashes; i++) {
+		bit = bloomBit(pus, fp, i);
+		if ((pus->bloom[bit/64] & (1ULL << (bit%64))) == 0)
+			return false;
+	}
+
+	return *probe(pus, fp) == fp;
+}
+
+/*
+ * adds a fingerprint
+ * inputs: set, fingerprint
+ * outputs: 1 if the fingerprint was not in the set before, 0 if it was, -1 if the table cannot grow
+ */
+int32_t usaddfp(urlset_t *usp, uint64_t fp) {
+	// Variable declarations.
+	privateurlset_t *pus = (privateurlset_t *)usp;
+	uint64_t *slot;
+
+	// Already there.
+	if (uscontainsfp(usp, fp))
+		return 0;
+
+	// Keep the table at most three quarters full.
+	if (pus->count + 1 > pus->size/4*3 && grow(pus) != 0)
+		return -1;
+
+	slot = probe(pus, fp);
+	*slot = fp;
+	pus->count++;
+
+	// Set the fingerprint's Bloom bits.
+	setBloom(pus, fp);
+
+	return 1;
+}
+
+/*
+ * adds a URL
+ * inputs: set, URL
+ * outputs: 1 if the URL was not in the set before, 0 if it was, -1 if the table cannot grow
+ */
+int32_t usadd(urlset_t *usp, const char *url) {
+	return usaddfp(usp, urlfingerprint(url, strlen(url)));
+}
+
+/*
+ * checks for a URL
+ * inputs: set, URL
+ * outputs: true if the URL is in the set
+ */
+bool uscontains(urlset_t *usp, const char *url) {
+	return uscontainsfp(usp, urlfingerprint(url, strlen(url)));
+}
+
+/*
+ * returns the number of URLs in the set
+ */
+uint32_t uscount(urlset_t *usp) {
+	return ((privateurlset_t *)usp)->count;
+}
+
+/*
+ * writes a set to a file: the header fields, then the table, then the Bloom filter
+ * inputs: set, file open for binary writing
+ * outputs: 0 for success, non-zero otherwise
+ */
+int32_t ussave(urlset_t *usp, FILE *fp) {
+	privateurlset_t *pus = (privateurlset_t *)usp;
+
+	if (fwrite(&pus->size, sizeof(pus->size), 1, fp) != 1 ||
+			fwrite(&pus->count, sizeof(pus->count), 1, fp) != 1 ||
+			fwrite(&pus->bloomBits, sizeof(pus->bloomBits), 1, fp) != 1 ||
+			fwrite(&pus->hashes, sizeof(pus->hashes), 1, fp) != 1 ||
+			fwrite(pus->slots, sizeof(uint64_t), pus->size, fp) != pus->size ||
+			(pus->bloomBits > 0 && fwrite(pus->bloom, sizeof(uint64_t), pus->bloomBits/64, fp) != pus->bloomBits/64))
+		return 1;
+
+	return 0;
+}
+
+/*
+ * reads a set written by ussave
+ * inputs: file open for binary reading
+ * outputs: the set, NULL on failure
+ */
+urlset_t *usload(FILE *fp) {
+	privateurlset_t *pus;
+	uint32_t i, used = 0;
+
+	if ((pus = (privateurlset_t *)calloc(1, sizeof(privateurlset_t))) == NULL)
+		return NULL;
+
+	// Read the header, which must describe a table probe() can search: a power of two with an empty slot,
+	// and a filter of whole words that is hashed into if and only if it exists.
+	if (fread(&pus->size, sizeof(pus->size), 1, fp) != 1 ||
+			fread(&pus->count, sizeof(pus->count), 1, fp) != 1 ||
+			fread(&pus->bloomBits, sizeof(pus->bloomBits), 1, fp) != 1 ||
+			fread(&pus->hashes, sizeof(pus->hashes), 1, fp) != 1 ||
+			pus->size == 0 || (pus->size & (pus->size - 1)) != 0 || pus->count >= pus->size ||
+			pus->bloomBits%64 != 0 || (pus->bloomBits > 0) != (pus->hashes > 0)) {
+		free(pus);
+		return NULL;
+	}
+
+	// Then allocate room for the table and filter it describes.
+	if ((pus->slots = (uint64_t *)malloc(pus->size*sizeof(uint64_t))) == NULL ||
+			(pus->bloomBits > 0 && (pus->bloom = (uint64_t *)malloc(pus->bloomBits/8)) == NULL) ||
+			fread(pus->slots, sizeof(uint64_t), pus->size, fp) != pus->size ||
+			(pus->bloomBits > 0 && fread(pus->bloom, sizeof(uint64_t), pus->bloomBits/64, fp) != pus->bloomBits/64)) {
+		usclose(pus);
+		return NULL;
+	}
+
+	// The table must hold as many fingerprints as the header says.
+	for (i = 0; i < pus->size; i++)
+		if (pus->slots[i] != 0)
+			used++;
+	if (used != pus->count) {
+		usclose(pus);
+		return NULL;
+	}
+
+	return (urlset_t *)pus;
+}
@@ -0,0 +1,59 @@
+#pragma once
+/*
+ * urlset.h --- public interface to the visited-URL set module
+ *
+ * Author: Joshua M. Meise
+ * Created: 11-04-2023
+ * Version: 1.0
+ *
+ * Description: A set of URLs stored as 64-bit fingerprints in an open-addressed table,
+ *              so membership costs one hash and a short probe and each URL takes a few
+ *              bytes no matter how long it is. A Bloom filter may be put in front of the
+ *              table to answer most lookups of new URLs without touching it.
+ *
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/* the set representation is hidden from users of the module */
+typedef void urlset_t;
+
+/* urlfingerprint -- returns the 64-bit fingerprint of the first len characters of url */
+uint64_t urlfingerprint(const char *url, size_t len);
+
+/* usopen -- opens an empty set sized for about hint URLs
+ * bloombits -- bits of Bloom filter per URL in front of the table, 0 for none;
+ *              the filter is sized for hint URLs and doubles with the table
+ */
+urlset_t *usopen(uint32_t hint, uint32_t bloombits);
+
+/* usclose -- closes a set and frees everything in it */
+void usclose(urlset_t *usp);
+
+/* usadd -- adds a URL to the set
+ * returns 1 if the URL was not in the set before; 0 if it was; -1 if memory runs out
+ */
+int32_t usadd(urlset_t *usp, const char *url);
+
+/* uscontains -- returns true if the URL is in the set */
+bool uscontains(urlset_t *usp, const char *url);
+
+/* usaddfp, uscontainsfp -- as usadd and uscontains, given a fingerprint */
+int32_t usaddfp(urlset_t *usp, uint64_t fp);
+bool uscontainsfp(urlset_t *usp, uint64_t fp);
+
+/* uscount -- returns the number of URLs in the set */
+uint32_t uscount(urlset_t *usp);
+
+/* ussave -- writes a set to an open binary file
+ * returns 0 for success; non-zero otherwise
+ */
+int32_t ussave(urlset_t *usp, FILE *fp);
+
+/* usload -- reads a set written by ussave from an open binary file
+ * returns the set, NULL on failure or if what is read is not a set
+ */
+urlset_t *usload(FILE *fp);
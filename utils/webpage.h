@@ -10,6 +10,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <curl/curl.h>
 
 /***********************************************************************/
@@ -59,6 +60,9 @@ void webpage_delete(void *data);
  *     2. page->url contains the url to curl
  *     3. page->html is NULL at call time
  *
+ * This function does not pace itself; a crawler must schedule fetches
+ * so that it does not overload any one server (see frontier.h).
+ *
  * Usage example:
  * webpage_t* page = webpage_new("http://www.example.com", 0, NULL);
  * if(webpage_fetch(page)) {
@@ -73,14 +77,115 @@ void webpage_delete(void *data);
  */
 bool webpage_fetch(webpage_t *page);
 
+/***************** conditional fetches ******************************/
+/* webpage_setValidators -- make later fetches of page conditional:
+ * the request carries If-None-Match: etag and If-Modified-Since: lastmod
+ * (either may be NULL or empty to leave it out), so a server whose copy
+ * has not changed answers 304 Not Modified with an empty body.
+ *
+ * After a fetch:
+ * webpage_getStatus(page) -- HTTP status of the response, 0 if none
+ * webpage_notModified(page) -- true if the status is 304; the fetch
+ *     counts as a success and page->html is empty
+ * webpage_getETag(page), webpage_getLastModified(page) -- validators of
+ *     the response, NULL if the server sent none; owned by the page
+ */
+void  webpage_setValidators(webpage_t *page, const char *etag, const char *lastmod);
+long  webpage_getStatus(const webpage_t *page);
+bool  webpage_notModified(const webpage_t *page);
+char *webpage_getETag(const webpage_t *page);
+char *webpage_getLastModified(const webpage_t *page);
+
+/***************** streaming fetches ******************************/
+/* webpage_setSink -- send the body of later fetches of page straight to
+ * sink, an open file, starting at its current position, instead of
+ * keeping it in memory; page->html stays empty and webpage_getHTMLlen()
+ * is the number of bytes written.  A retried transfer starts over at
+ * the same position.  NULL keeps the body in memory again.
+ *
+ * webpage_getSink(page) -- the page's sink, NULL if none
+ */
+void  webpage_setSink(webpage_t *page, FILE *sink);
+FILE *webpage_getSink(const webpage_t *page);
+
+/***************** webpage_fetcher ******************************/
+/* webpage_fetcher_t: opaque, long-lived fetcher that keeps a pool of
+ * curl handles.  Handles are reused from fetch to fetch and share one
+ * cache of DNS results, TLS sessions and open connections, so repeated
+ * fetches from the same host skip connection setup.  A fetcher may be
+ * used from several threads at once.
+ *
+ * webpage_fetch() and webpage_multi_new() use a default fetcher that
+ * lives as long as the process.
+ *
+ * webpage_fetcher_new() -- returns a new fetcher, NULL on error.
+ * webpage_fetcher_fetch(fp, page) -- as webpage_fetch(), through fp.
+ * webpage_fetcher_delete(fp) -- free fp; no fetch may be in progress.
+ */
+typedef struct webpage_fetcher webpage_fetcher_t;
+
+webpage_fetcher_t *webpage_fetcher_new(void);
+bool webpage_fetcher_fetch(webpage_fetcher_t *fp, webpage_t *page);
+void webpage_fetcher_delete(webpage_fetcher_t *fp);
+
+/***************** webpage_multi ******************************/
+/* webpage_multi_t: opaque struct that drives many fetches at once
+ * through the libcurl multi interface.  Pages handed to the driver
+ * follow the same assumptions as webpage_fetch(); each transfer is
+ * retried the same number of times before it is reported as failed.
+ *
+ * Usage example: (keep up to 8 transfers in flight)
+ * webpage_multi_t *mp = webpage_multi_new(8);
+ * webpage_multi_add(mp, webpage_new("http://www.example.com", 0, NULL));
+ * while ((page = webpage_multi_next(mp, -1, &ok)) != NULL) {
+ *     if (ok) printf("Found html: %s\n", webpage_getHTML(page));
+ *     webpage_delete(page);
+ * }
+ * webpage_multi_delete(mp);
+ */
+typedef struct webpage_multi webpage_multi_t;
+
+/* webpage_multi_new -- create a driver allowing up to maxinflight
+ * concurrent transfers; returns NULL on any error.
+ */
+webpage_multi_t *webpage_multi_new(int maxinflight);
+
+/* webpage_multi_add -- start fetching page in the background.
+ * Returns false if the driver is already full or the transfer cannot
+ * be started; the caller still owns the page in that case.
+ */
+bool webpage_multi_add(webpage_multi_t *mp, webpage_t *page);
+
+/* webpage_multi_next -- wait up to timeout_ms milliseconds (forever if
+ * negative) for a transfer to finish and hand its page back to the
+ * caller, setting *ok as webpage_fetch() would return.  Returns NULL
+ * if nothing finished in time or nothing is in flight.
+ */
+webpage_t *webpage_multi_next(webpage_multi_t *mp, int timeout_ms, bool *ok);
+
+/* webpage_multi_inflight -- number of transfers not yet handed back */
+int webpage_multi_inflight(const webpage_multi_t *mp);
+
+/* webpage_multi_apply -- call fn on the page of every transfer in flight */
+void webpage_multi_apply(webpage_multi_t *mp, void (*fn)(void *page));
+
+/* webpage_multi_delete -- abort any transfers still in flight, delete
+ * their pages, and free the driver.
+ */
+void webpage_multi_delete(webpage_multi_t *mp);
+
 
 /**************** webpage_getNextWord ***********************************/
 /* return the next word from html[pos] into word
  *
  * Assumptions:
  *     1. webpage has html
- *     2. don't care about opening/closing tags: ignore anything between <...>
- *     3. if the html is malformed, we don't care: match '<' with next '>'
+ *     2. words are runs of letters in the text a browser would show: tags
+ *        are skipped, as are scripts, style sheets, comments and CDATA
+ *        sections, and a character reference such as &amp; separates
+ *        words rather than being one
+ *     3. if the html is malformed, we don't care: markup that is never
+ *        closed ends the words
  *
  * Memory contract:
  *     1. inbound, webpage points to an existing struct, with existing html;
@@ -90,6 +195,59 @@ bool webpage_fetch(webpage_t *page);
 
 int webpage_getNextWord(webpage_t *page, int pos, char **word);
 
+/****************** webpage_getWords ***********************************/
+/* webpage_word_t: a word found in a page, as a span of its html */
+typedef struct webpage_word {
+  int start;                               // offset of the word in the html
+  int len;                                 // length of the word
+} webpage_word_t;
+
+/* find the next words of a page without copying them
+ * @page: pointer to the webpage info, with html
+ * @pos: where to start in the html, 0 on the first call; moved past the
+ *       last word found, or to -1 once the html runs out
+ * @words: array receiving up to max words, in the order they appear
+ *
+ * Returns the number of words found, 0 once there are no more, or -1 on
+ * error.  Words are found as webpage_getNextWord() finds them, and the
+ * html is not changed, so the spans stay valid as long as the html.
+ *
+ * Usage example: (visit all words of a page, 256 at a time)
+ * webpage_word_t words[256];
+ * int pos = 0, n;
+ * while ((n = webpage_getWords(page, &pos, words, 256)) > 0) {
+ *     for (int i = 0; i < n; i++)
+ *         printf("%.*s\n", words[i].len, webpage_getHTML(page) + words[i].start);
+ * }
+ */
+int webpage_getWords(const webpage_t *page, int *pos, webpage_word_t *words, int max);
+
+/****************** webpage_getTerms ***********************************/
+/* webpage_term_t: a word found in a page, with the hash of its lowercase form */
+typedef struct webpage_term {
+  int start;                               // offset of the word in the html
+  int len;                                 // length of the word
+  uint32_t hash;                           // webpage_termHash() of the word, lowercased
+} webpage_term_t;
+
+/* find the next words of a page of at least minlen letters, and hash them
+ * @page, @pos: as for webpage_getWords()
+ * @terms: array receiving up to max words, in the order they appear
+ * @minlen: shorter words are skipped
+ *
+ * Returns the number of words found, 0 once there are no more, or -1 on
+ * error.  The words are those webpage_getWords() finds, less the short
+ * ones, found in the same single pass that hashes them, so a word can be
+ * looked up in a table keyed by webpage_termHash() without first being
+ * copied or lowercased.
+ */
+int webpage_getTerms(const webpage_t *page, int *pos, webpage_term_t *terms, int max, int minlen);
+
+/* hash of the len letters of word, as if lowercased; the hash that
+ * webpage_getTerms() gives the same word
+ */
+uint32_t webpage_termHash(const char *word, int len);
+
 /****************** webpage_getNextURL ***********************************/
 /* return the next url from html[pos] into result
  * @page: pointer to the webpage info
@@ -104,7 +262,7 @@ int webpage_getNextWord(webpage_t *page, int pos, char **word);
  * buffer; may be NULL on failed return. The caller is responsible for free'ing
  * this memory.
  *
- * Side effect: the page's html will be compressed to remove white space.
+ * The page's html is left as it is.
  *
  * Usage example: (retrieve all urls in a page)
  * int pos = 0;
@@ -119,6 +277,86 @@ int webpage_getNextWord(webpage_t *page, int pos, char **word);
 
 int webpage_getNextURL(webpage_t *page, int pos, char **result);
 
+/****************** webpage_getLinks ***********************************/
+/* webpage_link_t: a link found in a page, as a span of its html */
+typedef struct webpage_link {
+  int start;                               // offset of the url in the html
+  int len;                                 // length of the url, without any #fragment
+  bool relative;                           // must be resolved against the page's url
+} webpage_link_t;
+
+/* find every link in a page in one pass over its html
+ * @page: pointer to the webpage info, with html
+ * @links: set to a new array of the links, in the order they appear
+ *
+ * Returns the number of links, or -1 on error.  The caller must free
+ * *links.  Links are found as webpage_getNextURL() finds them, and the
+ * html is not changed, so the spans stay valid as long as the html.
+ *
+ * Usage example: (retrieve all urls in a page)
+ * webpage_link_t *links;
+ * int n = webpage_getLinks(page, &links);
+ * for (int i = 0; i < n; i++) {
+ *     char *url = webpage_resolveLink(page, &links[i]);
+ *     ...
+ *     free(url);
+ * }
+ * free(links);
+ */
+int webpage_getLinks(const webpage_t *page, webpage_link_t **links);
+
+/* webpage_resolveLink -- copy a link of page into a new buffer,
+ * dropping any white space, and make it absolute if it is relative.
+ * Returns NULL on error; the caller must free the result.
+ */
+char *webpage_resolveLink(const webpage_t *page, const webpage_link_t *link);
+
+/****************** webpage_canonLink ***********************************/
+/* webpage_base_t: a page's url split up once, so that each of its
+ * links can be resolved without parsing the url again.  Only valid as
+ * long as the page's url.
+ */
+typedef struct webpage_base {
+  const char *url;                         // the page's url
+  int scheme;                              // end of the scheme, e.g. "http://"
+  int host;                                // start of the host, after any user info
+  int root;                                // end of the host, where the path starts
+  int dir;                                 // end of the path up to its last '/'
+} webpage_base_t;
+
+/* webpage_getBase -- split the url of page into base.
+ * Returns false if the url cannot be parsed; relative links of the
+ * page then cannot be resolved.
+ */
+bool webpage_getBase(const webpage_t *page, webpage_base_t *base);
+
+/* webpage_canonLink -- resolve and normalize a link of page into buf
+ * @page: page the link was found in
+ * @base: page's url, from webpage_getBase(); NULL if it has none
+ * @link: link to canonicalize
+ * @buf: buffer of size characters receiving the url, terminated
+ * @fp: set to urlfingerprint() of the url if not NULL
+ *
+ * Gives the url that webpage_resolveLink() followed by NormalizeURL()
+ * would, without allocating any memory.  Returns its length; 0 if the
+ * link is rejected, as NormalizeURL() would reject it; -1 if it does
+ * not fit in buf, which never happens if size is at least link->len
+ * plus the length of the page's url plus 2.
+ *
+ * Usage example: (queue the new internal urls of a page)
+ * char url[2048];
+ * uint64_t fp;
+ * webpage_base_t base;
+ * bool ok = webpage_getBase(page, &base);
+ * for (int i = 0; i < n; i++) {
+ *     if (webpage_canonLink(page, ok ? &base : NULL, &links[i], url, sizeof(url), &fp) > 0
+ *         && webpage_isInternal(url) && usaddfp(seen, fp))
+ *         ... webpage_new(url, depth + 1, NULL) ...
+ * }
+ */
+int webpage_canonLink(const webpage_t *page, const webpage_base_t *base,
+                      const webpage_link_t *link, char *buf, int size, uint64_t *fp);
+
 /***********************************************************************
  * NormalizeURL - attempts to normalize the url
  * @url: absolute url to normalize
@@ -147,11 +385,27 @@ bool NormalizeURL(char *url);
  * returns false otherwise.
  * 
  * "valid" means that NormalizeURL() returns true;
- * "internal" means that the url begins with INTERNAL_URL_PREFIX.
+ * "internal" means that the url begins with the internal prefix.
  */
 bool IsInternalURL(char *url);
 
-// All URLs beginning with this prefix are considered "internal"
+/* webpage_isInternal -- as IsInternalURL() for a url that is already
+ * normalized, e.g. by webpage_canonLink(); url is only read.
+ */
+bool webpage_isInternal(const char *url);
+
+// By default all URLs beginning with this prefix are considered "internal"
 static const
   char INTERNAL_URL_PREFIX[] = "https://thayer.github.io/engs50";
 
+/***********************************************************************
+ * webpage_setInternalPrefix - make IsInternalURL accept URLs beginning
+ * with prefix instead, e.g. a mirror of the site on the loopback
+ * interface; the string is copied, and NULL restores INTERNAL_URL_PREFIX.
+ * Call it before any thread uses IsInternalURL.
+ *
+ * webpage_getInternalPrefix - the prefix IsInternalURL uses now
+ */
+void webpage_setInternalPrefix(const char *prefix);
+const char *webpage_getInternalPrefix(void);
+